@@ -4,6 +4,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#define GOMOKU_X86_SIMD // 全盘扫描的 SSE2 内核 (运行时按 CPUID 选择)
+#include <immintrin.h>
+#endif
 #endif
 
 typedef long long LL; // 用于存储棋局评估分数 (需要大范围以区分胜负和细微优势)
@@ -14,6 +29,13 @@ int BOARD_SIZE = 12; // 棋盘尺寸 (动态)
 #define EMPTY_SLOT 0  // 棋盘空点
 #define PIECE_B    1  // 黑棋
 #define PIECE_W    2  // 白棋
+#define CELL_WALL  3  // 棋盘外的哨兵格 (与线编码中的界外同值)
+
+// 一维棋盘: 四周留出 BOARD_PADDING 格哨兵, 相邻两行共用中间的哨兵列; 从棋盘上任一点沿任意方向走 BOARD_PADDING 步都不会越出数组
+#define BOARD_PADDING 5
+#define BOARD_STRIDE (MAX_BOARD_SIZE + BOARD_PADDING) // 行跨度
+#define BOARD_CELLS ((MAX_BOARD_SIZE + 2 * BOARD_PADDING + 1) * BOARD_STRIDE)
+#define CELL_INDEX(row, col) (((row) + BOARD_PADDING) * BOARD_STRIDE + BOARD_PADDING + (col))
 
 // 定义极大/极小值, 用于Alpha-Beta剪枝的边界
 const LL SCORE_MAX = 8223372036854775808LL;
@@ -55,32 +77,171 @@ typedef enum {
 // 只需要检查4个方向即可覆盖所有8个方向 (水平, 垂直, 左上到右下, 右上到左下)
 const int gDirectionRow[] = {1, 0, 1, 1}; // 行变化 (垂直, 水平, \ , /)
 const int gDirectionCol[] = {0, 1, 1, -1}; // 列变化 (垂直, 水平, \ , /)
+const int gDirectionStride[] = {BOARD_STRIDE, 1, BOARD_STRIDE + 1, BOARD_STRIDE - 1}; // 一维棋盘上的下标变化
 
 // Alpha-Beta 搜索的最大深度 (奇数层确保AI多下一步)
 #define SEARCH_DEPTH 7
 
+// 迭代加深
+#define ID_DEPTH_STEP 2               // 每轮加深的层数 (步长为 2, 保持与 SEARCH_DEPTH 相同的奇偶性)
+#define DEFAULT_TIME_LIMIT_MS 5000    // 默认每步时间预算 (毫秒, 0 表示不限时)
+#define DEFAULT_NODE_LIMIT 0          // 默认每步节点预算 (0 表示不限)
+#define TIME_CHECK_INTERVAL 1023      // 每搜索 (该值 + 1) 个节点检查一次时钟
+#define ASPIRATION_WINDOW 1000LL      // 期望窗口半宽 (约一个活三的分值)
+#define ASPIRATION_GROWTH 8           // 分数落在窗口外时, 窗口放大的倍数
+
+// 多线程 (Lazy SMP): 所有线程共享置换表, 各自搜索自己的棋盘副本; wasm 版本始终单线程
+#ifdef GOMOKU_WASM
+#define MAX_THREADS 1
+#else
+#define MAX_THREADS 64                // THREADS 命令允许的最大线程数
+#endif
+#define PARALLEL_LAZY 0               // 并行模式: Lazy SMP (各线程独立迭代加深, 只共享置换表)
+#define PARALLEL_ROOT 1               // 并行模式: 根节点并行 (根节点着法作为任务, 线程间工作窃取, 共享最佳界)
+#define PARALLEL_YBWC 2               // 并行模式: YBWC (长子搜完后, 在任意节点分裂, 兄弟着法由空闲线程并行搜索)
+#define YBWC_MIN_SPLIT_DEPTH 4        // 允许分裂的最小剩余深度 (更浅的子树太小, 分裂开销大于收益)
+#define YBWC_MAX_SPLIT_POINTS 256     // 同时开放的分裂点上限
+
+// 后台思考 (Ponder, 仅原生模式): 对手思考期间, 在预测的对手应着之后的局面上提前搜索
+#define PONDER_IDLE 0                 // 没有后台思考
+#define PONDER_RUNNING 1              // 正在搜索预测着法之后的局面 (不受时间与节点预算限制)
+#define PONDER_HIT 2                  // 对手下了预测的着法, 后台搜索转为正式搜索, 等待 TURN 取结果
+
 // 候选着法
 #define MAX_CANDIDATES (MAX_BOARD_SIZE * MAX_BOARD_SIZE) // 候选着法数组的最大容量
 
+// 着法排序启发 (杀手着法 与 历史表)
+// 加分量级刻意控制在活三 (1100) 以下: 只调整同一威胁等级内的顺序, 不会让安静着法越过冲四/活三的攻防点
+#define MAX_PLY 64                    // 杀手着法表支持的最大层数 (根节点为第 0 层)
+#define KILLER_BONUS_PRIMARY 500LL    // 第一杀手着法的排序加分
+#define KILLER_BONUS_SECONDARY 400LL  // 第二杀手着法的排序加分
+#define HISTORY_BONUS_MAX 300LL       // 历史表排序加分的上限
+#define HISTORY_BONUS_SHIFT 4         // 历史分数右移位数 (缩放到排序加分)
+
+// 后期着法缩减 (Late Move Reductions) 的默认参数, 可在编译时用 -D 覆盖, 也可运行时用 LMR 命令修改
+#ifndef LMR_MAX_CANDIDATES
+#define LMR_MAX_CANDIDATES 10         // 每个节点保留的候选着法上限 (搜索宽度)
+#endif
+#ifndef LMR_FULL_DEPTH_MOVES
+#define LMR_FULL_DEPTH_MOVES 2        // 排序最靠前的 N 个着法始终全深度搜索
+#endif
+#ifndef LMR_MIN_DEPTH
+#define LMR_MIN_DEPTH 3               // 剩余深度不小于该值时才做缩减
+#endif
+#ifndef LMR_REDUCTION
+#define LMR_REDUCTION 2               // 安静着法缩减的层数 (偶数可保持叶节点的行棋方不变)
+#endif
+#define LMR_QUIET_SCORE SCORE_THREE_OPEN // 启发分低于此值 (不形成也不阻挡活三及以上) 的着法视为安静着法
+
+// 连续冲四 (VCF) 求解
+#define VCF_MAX_DEPTH 12                // 最多连续冲四的步数 (攻方着法数)
+#define VCF_MAX_LINE (VCF_MAX_DEPTH * 2) // 获胜着法序列的最大长度 (攻守交替)
+#define VCF_NODE_LIMIT 20000            // 主搜索前 VCF 预搜索的节点上限
+#define VCF_DEFENCE_NODE_LIMIT 2000     // 检验单个防守着法时 VCF 的节点上限
+#define VCF_CACHE_SIZE (1 << 16)        // VCF 失败局面缓存的条目数
+
+// 连续威胁 (VCT) 搜索: 攻方走冲四或活三, 守方考虑所有能化解威胁的着法
+#define VCT_MAX_DEPTH 8                 // 最多连续威胁的步数 (攻方着法数, 含被迫挡四)
+#define VCT_MAX_LINE (VCT_MAX_DEPTH * 2) // 获胜着法序列的最大长度
+#define VCT_NODE_LIMIT 20000            // 主搜索前 VCT 预搜索的节点上限
+#define VCT_TIME_LIMIT_MS 200           // 主搜索前 VCT 预搜索的时间上限 (毫秒; 只在本步限时的情况下使用)
+#define VCT_TIME_SHARE 4                // 限时的情况下 VCT 预搜索最多使用本步剩余时间的 1/VCT_TIME_SHARE
+#define VCT_CACHE_SIZE (1 << 16)        // VCT 失败局面缓存的条目数
+
+// 证明数搜索 (df-pn, 仅原生模式): 在与 VCT 相同的威胁空间内证明/否证攻方必胜
+#define DFPN_INFINITY 100000000U        // 证明数/反证数的 "无穷大"
+#define DFPN_NODE_LIMIT 1000000         // SOLVE 命令默认的节点上限
+#define DFPN_DEFAULT_MB 16              // SOLVE 命令默认的证明数表大小 (MB)
+#define DFPN_MAX_PLY 96                 // 最大递归层数 (攻守合计)
+#define DFPN_MAX_LINE 64                // 输出的获胜着法序列的最大长度
+#define DFPN_UNKNOWN 0                  // 求解结果: 超出预算, 未知
+#define DFPN_PROVEN 1                   // 求解结果: 攻方必胜
+#define DFPN_DISPROVEN 2                // 求解结果: 威胁空间内攻方没有必胜
+
 // 置换表
-#define TT_SIZE (1 << 20) // 置换表大小 (2^20, 约一百万条目)
+// 置换表容量 (MB, 运行时可调: 原生 HASH 命令 / wasm gomoku_init 的参数); 桶数取不超过容量的最大 2 的幂
+#ifdef GOMOKU_WASM
+#define TT_DEFAULT_MB 16          // wasm 默认容量 (线性内存按需增长, 手机上也不会一次占用过多)
+#define TT_MAX_MB 1024            // wasm32 地址空间只有 4GB
+#else
+#define TT_DEFAULT_MB 32
+#define TT_MAX_MB (1 << 20)       // 原生模式的上限 (1TB, 实际受物理内存限制)
+#define TT_ALIGNMENT (1 << 21)    // 原生模式按 2MB 对齐分配, 便于内核使用大页
+#define ZOBRIST_SEED 0x9E3779B97F4A7C15ULL // 原生模式固定的 Zobrist 种子 (键跨进程不变, 置换表文件才能沿用)
+#define TT_FILE_MAGIC 0x31305454544B4D47ULL // 置换表文件头的标识 ("GMKTTT01")
+#define TT_FILE_HEADER_BYTES 4096 // 文件头占一页, 表从页边界开始
+#endif
+#define TT_BUCKET_SIZE 4  // 每桶条目数 (4 x 16 字节 = 一条缓存行)
 #define TT_TYPE_EXACT 0   // 分数类型: 精确值 (Alpha 和 Beta 之间)
-#define TT_TYPE_ALPHA 1   // 分数类型: Alpha (下界, 实际分数 >= score, 发生了 Beta 剪枝)
-#define TT_TYPE_BETA  2   // 分数类型: Beta (上界, 实际分数 <= score, 发生了 Alpha 剪枝)
+#define TT_TYPE_ALPHA 1   // 分数类型: Alpha (上界, 实际分数 <= score, 未能超过 alpha)
+#define TT_TYPE_BETA  2   // 分数类型: Beta (下界, 实际分数 >= score, 发生了 Beta 剪枝)
+#define TT_TYPE_NONE  3   // 分数类型: 无分数 (只保存着法; 分数无法用 32 位表示时使用)
+#define TT_SCORE_LIMIT 0x7FFFFF00LL // 32 位分数编码: 绝对值不超过此值的分数原样存储, 之外的编码区留给胜负分
+#define TT_MATE_RANGE 64  // 距 SCORE_MAX/SCORE_MIN 不超过此值的分数视为胜负分
+#define MOVE_NONE    -1   // 置换表中 "没有最佳着法" 的标记
+#define SYMMETRY_COUNT 8  // 棋盘的对称变换数 (4 个旋转 x 是否镜像)
+#define LINE_WINDOW    5  // 棋型查表时中心点两侧各取的格数 (足以确定 analyzeLine 的结果)
+#define LINE_COUNT (2 * MAX_BOARD_SIZE - 1) // 每个对角线方向的线数上限 (垂直与水平方向各 MAX_BOARD_SIZE 条)
+#define LINE_TOTAL (2 * MAX_BOARD_SIZE + 2 * LINE_COUNT) // 4 个方向的线数之和 (线编码数组的长度)
+#define LINE_LOW_BITS 0x5555555555555555ULL // 线编码中每格的低位
+
+// 全盘扫描内核 (候选点与成五点的全盘扫描; wasm 与非 x86 构建只有标量内核)
+#define SCAN_KERNEL_AUTO   -1          // 按 CPUID 选择最快的可用内核
+#define SCAN_KERNEL_SCALAR 0           // 逐格检查 (isNearPiece / makesFive)
+#define SCAN_KERNEL_SSE2   1           // 每次比较 16 格 (原生棋盘一行只需一次)
 
 // --- 核心数据结构 --- //
 
 /**
- * @brief 置换表 (Transposition Table) 条目
+ * @brief 置换表 (Transposition Table) 条目 (16 字节)
  * 用于存储已搜索过的棋局状态, 避免重复计算
+ * 无锁协议: 两个字各自以原子操作读写 (不保证同时更新); 存储 Zobrist 键 ^ data, 读取时只有还原出的键与查询的键相同才采用,
+ * 因此读到两个不同写入交错而成的条目时校验失败, 视为未命中, 不会得到错误的分数
+ * data 的位布局: [0, 32) 分数 (32 位编码, 见 ttEncodeScore) | [32, 48) 最佳着法 + 1 (row * MAX_BOARD_SIZE + col + 1, 0 表示无)
+ *              | [48, 56) 剩余搜索深度 | [56, 58) 分数类型 ^ TT_TYPE_NONE | [58, 64) 写入时的置换表代数
+ * 着法与类型的偏移使全 0 的条目恰好是空条目 (无着法, 无分数): 清空即清零, 新分配或新建文件的零页无需初始化
  */
 typedef struct {
-    ULL key; // Zobrist 键 (用于快速校验是否是同一个棋局)
-    LL score; // 评估分数
-    int depth; // 剩余搜索深度 (存储时该局面的剩余深度)
-    int type; // 分数类型 (EXACT, ALPHA, BETA)
+    ULL keyXorData; // Zobrist 键 ^ data (无锁校验: 多线程并发写入时, 读到被写坏的条目会校验失败而被当作未命中)
+    ULL data; // 打包的条目内容
 } TT_Entry;
 
+/**
+ * @brief 置换表桶: 同一索引的若干条目占满一条缓存行, 一次缓存未命中即可检查全部候选
+ */
+typedef struct __attribute__((aligned(64))) {
+    TT_Entry entries[TT_BUCKET_SIZE];
+} TT_Bucket;
+
+/**
+ * @brief 置换表文件头 (原生 HASHFILE 命令; 文件 = 文件头页 + 桶数组, 整个文件映射为置换表)
+ */
+typedef struct {
+    ULL magic; // TT_FILE_MAGIC
+    ULL bucketCount; // 桶数 (2 的幂)
+    ULL zobristCheck; // Zobrist 键的指纹 (键不同的文件中的条目无法命中, 拒绝加载)
+    int bucketBytes; // sizeof(TT_Bucket) (条目格式)
+    int generation; // 保存时的置换表代数 (加载后从此继续, 文件中的条目按旧代处理)
+} TT_FileHeader;
+
+/**
+ * @brief VCF 缓存条目: 记录 "攻方在该局面下 depth 步内没有连续冲四胜" 的结论
+ */
+typedef struct {
+    ULL key; // Zobrist 键 ^ 攻方标记
+    int depth; // 已证明无解的剩余步数
+} VCF_Entry;
+
+/**
+ * @brief df-pn 证明数表条目
+ */
+typedef struct {
+    ULL key; // Zobrist 键 ^ 攻方标记 (守方节点再异或 gDfpnAndKey)
+    unsigned int pn; // 证明数 (0 = 已证明攻方必胜)
+    unsigned int dn; // 反证数 (0 = 已证明攻方无法取胜)
+    ULL work; // 求解该节点消耗的节点数 (替换时保留代价更大的条目)
+} DFPN_Entry;
+
 /**
  * @brief 棋型得分表 (区分我方和对手)
  */
@@ -123,13 +284,90 @@ typedef struct {
  */
 typedef struct {
     ULL currentHash; // 当前棋盘的 Zobrist 哈希值
-    int layout[MAX_BOARD_SIZE][MAX_BOARD_SIZE]; // 棋盘布局 (0:空, 1:B, 2:W)
+    ULL symmetryHashes[SYMMETRY_COUNT]; // 8 个对称变换后局面的 Zobrist 哈希 (只在对称模式下维护; [0] 即 currentHash)
+    unsigned char cells[BOARD_CELLS]; // 一维棋盘布局 (0:空, 1:B, 2:W; 棋盘外为 CELL_WALL), 下标为 CELL_INDEX(row, col)
+    // 4 个方向上每条线的 2 位格编码 (线上第 k 格位于第 2 * (k + LINE_WINDOW) 位, 两端之外为界外), 由 boardUpdate 维护;
+    // 各方向的线依次排列 (见 lineLocate). 棋型由此查表得到, 不另行保存, 复制棋盘时只需复制这些编码
+    ULL lineCodes[LINE_TOTAL];
+    // 增量评估 (由 boardUpdate 维护, evaluateBoardScore 直接读取总分)
+    LL threatTotals[3]; // 按棋子累计的威胁分
 } ChessBoard;
 
+/**
+ * @brief 搜索宽度与后期着法缩减 (LMR) 的参数
+ */
+typedef struct {
+    int maxCandidates; // 每个节点保留的候选着法上限
+    int fullDepthMoves; // 前 N 个着法不缩减
+    int minDepth; // 剩余深度 >= minDepth 才缩减
+    int reduction; // 缩减层数 (0 表示关闭 LMR)
+} LmrConfig;
+
+/**
+ * @brief 每步搜索的预算 (由协议命令或 wasm 导出函数设置)
+ */
+typedef struct {
+    int maxDepth; // 迭代加深的最大深度
+    LL timeLimitMs; // 每步时间预算 (毫秒, 0 = 不限)
+    ULL nodeLimit; // 每步节点预算 (0 = 不限)
+} SearchLimits;
+
+/**
+ * @brief 单次 determineNextPlay 的运行状态
+ * 节点数按线程分别计数 (SearchWorker.nodes), 这里只保存起点; 每个节点都要读取的 stopped 独占一个缓存行,
+ * 其余字段只在检查点读取
+ */
+typedef struct {
+    LL startMs; // 搜索开始时刻 (毫秒)
+    LL deadlineMs; // 截止时刻 (毫秒, 0 = 不限)
+    ULL nodeBase; // 搜索开始 (或后台思考命中) 时各线程节点计数之和
+    int pondering; // 后台思考中: 不检查时间与节点预算, 只能被 searchStop 中止 (命中时由主线程清除, 须原子读写)
+    int stopped __attribute__((aligned(64))); // 是否已因预算耗尽而中止 (中止后的搜索结果一律作废; 多线程时由任意线程置位, 须原子读写)
+} SearchState;
+
+struct SplitPoint;
+
+/**
+ * @brief 着法排序启发表 (杀手着法与历史分数), 整体赋值即可保存或恢复
+ */
+typedef struct {
+    Coord killerMoves[MAX_PLY][2]; // 每层两个杀手着法 (引发过剪枝的着法)
+    LL historyScores[3][MAX_BOARD_SIZE][MAX_BOARD_SIZE]; // 按 [棋子][行][列] 累计的历史分数
+} OrderingTables;
+
+/**
+ * @brief 搜索线程的私有状态 (Lazy SMP: 每个线程一份, 只有置换表是共享的)
+ * 按缓存行对齐: 相邻线程频繁写入的杀手着法与历史表不会落在同一缓存行上 (避免伪共享)
+ */
+typedef struct __attribute__((aligned(64))) {
+    int id; // 线程编号 (0 为主线程, 决定最终着法)
+    ULL nodes; // 本线程累计搜索的节点数 (只由本线程写入, 从不清零; 其他线程在检查点读取求和)
+    ULL nextCheckNodes; // nodes 达到此值时检查预算
+    ChessBoard board; // 线程私有的棋盘副本
+    CandidateList rootList; // 根节点候选着法 (辅助线程会轮转顺序, 使各线程先搜不同的分支)
+    OrderingTables ordering; // 杀手着法与历史表
+    struct SplitPoint *splitPoint; // 当前所在的最内层分裂点 (YBWC; 不在分裂点内时为 NULL)
+} SearchWorker;
+
 // --- 全局变量 --- //
 
 #ifdef GOMOKU_WASM
 #define WASM_EXPORT __attribute__((visibility("default")))
+#define WASM_IMPORT(name) __attribute__((import_module("env"), import_name(name)))
+
+// 由宿主 (前端 JS) 提供的毫秒时钟, 例如 performance.now()
+WASM_IMPORT("gomoku_now_ms") double gomoku_now_ms(void);
+
+// 结构体整体赋值 (如复制 ChessBoard) 会被编译成 memcpy 调用, 而 wasm 构建不链接 C 运行时, 在这里提供
+// (no_builtin: 防止编译器把这个循环本身再识别成 memcpy 调用)
+__attribute__((no_builtin("memcpy"))) void *memcpy(void *dest, const void *src, __SIZE_TYPE__ n) {
+    unsigned char *d = (unsigned char *) dest;
+    const unsigned char *s = (const unsigned char *) src;
+    while (n--) {
+        *d++ = *s++;
+    }
+    return dest;
+}
 #else
 #define WASM_EXPORT
 #endif
@@ -144,21 +382,81 @@ static ULL gPrngState;
 // gZobristKeys[p][i][j] 表示棋子p在(i,j)位置时的随机哈希值
 ULL gZobristKeys[3][MAX_BOARD_SIZE][MAX_BOARD_SIZE];
 // 全局置换表 (TT)
-TT_Entry *gTranspositionTable;
-static TT_Entry gTranspositionTableStorage[TT_SIZE];
+TT_Bucket *gTranspositionTable; // 运行时分配 (见 ttResize)
+ULL gTtBucketCount; // 桶数 (2 的幂, 0 表示尚未分配)
+int gTtMegabytes; // 当前容量 (MB)
+#ifndef GOMOKU_WASM
+static unsigned char *gTtMapping; // 映射的置换表文件 (NULL 表示置换表在堆上)
+static ULL gTtMappingBytes;
+#ifdef _WIN32
+static HANDLE gTtMappingFile;
+#endif
+#endif
+static int gTtGeneration; // 置换表代数 (低 6 位存入条目): 每次决策加一, 之前决策留下的条目仍可命中, 但优先被替换
+ULL gTtSideKeys[3]; // 按 AI 一方混入置换表键 (分数以 AI 为 Maximizer, AI 执黑与执白的条目互不混用)
+
+// VCF 求解器: 失败局面缓存, 区分攻方的哈希标记, 以及单次求解的节点计数
+static VCF_Entry gVcfCache[VCF_CACHE_SIZE];
+ULL gVcfAttackerKeys[3];
+static ULL gVcfNodes;
+static ULL gVcfNodeLimit;
+static int gVcfAborted;
+
+// VCT 搜索: 失败局面缓存 (复用 VCF_Entry 结构) 以及单次搜索的预算状态
+static VCF_Entry gVctCache[VCT_CACHE_SIZE];
+static ULL gVctNodes;
+static ULL gVctNodeLimit;
+static LL gVctDeadlineMs;
+static int gVctAborted;
+
+// df-pn: 守方节点的哈希标记 (证明数表本身只在原生模式下按需分配)
+ULL gDfpnAndKey;
+#ifndef GOMOKU_WASM
+static DFPN_Entry *gDfpnTable;
+static ULL gDfpnTableSize; // 条目数 (2 的幂)
+static int gDfpnTableMB; // 分配时使用的内存上限 (MB)
+static ULL gDfpnNodes;
+static ULL gDfpnNodeLimit;
+static int gDfpnAborted;
+#endif
 
 // 这是AI评估的核心: 不同棋型的基础分值
 PatternTable gPatternScores;
+// 棋型查找表: 以中心点两侧各 LINE_WINDOW 格的编码为下标, 低 4 位为黑棋落在中心时的棋型, 高 4 位为白棋
+static unsigned char gLinePatternTable[1 << (4 * LINE_WINDOW)];
+static int gLinePatternTableReady;
 
 // 全局唯一棋盘状态
 ChessBoard gCurrentBoard;
 
+// 搜索线程 (gWorkers[0] 为主线程; 杀手着法与历史表随线程保存, 跨步保留以便老化)
+SearchWorker gWorkers[MAX_THREADS];
+int gThreadCount = 1;
+int gParallelMode = PARALLEL_LAZY;
+
+// 全盘扫描内核 (SCAN_KERNEL_*, 原生模式启动时按 CPUID 选择, 可用 SIMD 命令切换)
+int gScanKernel = SCAN_KERNEL_SCALAR;
+
+// 对称模式: 置换表按 8 个对称局面中的规范局面 (哈希最小者) 存取, 互为镜像/旋转的局面共用条目
+int gSymmetryHash;
+
+// 搜索宽度与后期着法缩减参数
+LmrConfig gLmrConfig = {LMR_MAX_CANDIDATES, LMR_FULL_DEPTH_MOVES, LMR_MIN_DEPTH, LMR_REDUCTION};
+
+// 搜索预算与本次搜索的运行状态
+SearchLimits gSearchLimits = {SEARCH_DEPTH, DEFAULT_TIME_LIMIT_MS, DEFAULT_NODE_LIMIT};
+SearchState gSearchState;
+
+// 后台思考 (仅由原生模式的 PONDER 命令置位)
+int gPonderSearch; // 正在执行的 determineNextPlay 是后台思考 (计时已由 ponderStart 启动)
+
 static void clearTranspositionTable() {
-    for (int i = 0; i < TT_SIZE; i++) {
-        gTranspositionTableStorage[i].key = 0;
-        gTranspositionTableStorage[i].score = 0;
-        gTranspositionTableStorage[i].depth = 0;
-        gTranspositionTableStorage[i].type = 0;
+    // 全 0 即空条目 (无分数, 无着法; 与键还原为 0 的局面 "匹配" 也不会带来任何信息)
+    for (ULL i = 0; i < gTtBucketCount; i++) {
+        for (int k = 0; k < TT_BUCKET_SIZE; k++) {
+            gTranspositionTable[i].entries[k].keyXorData = 0;
+            gTranspositionTable[i].entries[k].data = 0;
+        }
     }
 }
 
@@ -169,13 +467,60 @@ static void clearPatternTable(PatternTable *table) {
     }
 }
 
+/**
+ * @brief 求 (row, col) 在方向 d 上所在的线 (lineCodes 的下标) 与线上的位置 (沿 gDirectionRow/gDirectionCol 的正方向递增)
+ */
+static void lineLocate(const int d, const int row, const int col, int *line, int *pos) {
+    switch (d) {
+        case 0: // 垂直: 每列一条线
+            *line = col;
+            *pos = row;
+            break;
+        case 1: // 水平: 每行一条线
+            *line = MAX_BOARD_SIZE + row;
+            *pos = col;
+            break;
+        case 2: // "\": row - col 相同
+            *line = 2 * MAX_BOARD_SIZE + row - col + BOARD_SIZE - 1;
+            *pos = row;
+            break;
+        default: // "/": row + col 相同
+            *line = 2 * MAX_BOARD_SIZE + LINE_COUNT + row + col;
+            *pos = row;
+            break;
+    }
+}
+
 static void clearBoard(ChessBoard *board) {
+    // 先全部置为哨兵, 再把 BOARD_SIZE 以内的格清为空 (棋盘小于 MAX_BOARD_SIZE 时多出的行列也是哨兵)
+    for (int k = 0; k < BOARD_CELLS; k++) {
+        board->cells[k] = CELL_WALL;
+    }
     for (int i = 0; i < BOARD_SIZE; i++) {
         for (int j = 0; j < BOARD_SIZE; j++) {
-            board->layout[i][j] = EMPTY_SLOT;
+            board->cells[CELL_INDEX(i, j)] = EMPTY_SLOT;
         }
     }
     board->currentHash = 0;
+    for (int s = 0; s < SYMMETRY_COUNT; s++) {
+        board->symmetryHashes[s] = 0;
+    }
+    // 线编码: 先全部置为界外, 再把棋盘上的格清为空
+    for (int line = 0; line < LINE_TOTAL; line++) {
+        board->lineCodes[line] = ~0ULL;
+    }
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            for (int d = 0; d < 4; d++) {
+                int line, pos;
+                lineLocate(d, i, j, &line, &pos);
+                board->lineCodes[line] &= ~(3ULL << 2 * (pos + LINE_WINDOW));
+            }
+        }
+    }
+    for (int p = 0; p < 3; p++) {
+        board->threatTotals[p] = 0;
+    }
 }
 
 static void sortCandidatesByScore(CandidateList *list) {
@@ -226,6 +571,310 @@ ULL genU64Rand() {
 
 // --- Zobrist 与置换表函数 --- //
 
+#ifdef GOMOKU_WASM
+extern unsigned char __heap_base; // 链接器提供: 静态数据之后的第一个空闲地址
+#define WASM_PAGE_SIZE 65536
+
+/**
+ * @brief wasm: 置换表放在 __heap_base 之后 (对齐到 64 字节), 线性内存不够时按页增长
+ * (wasm 版本没有其他堆分配, 重新分配时直接复用同一块内存; 线性内存只增不减)
+ * @param bytes 需要的字节数
+ * @return 置换表地址 (内存无法增长时为 0)
+ */
+static TT_Bucket *ttAllocate(const ULL bytes) {
+    const unsigned long base = ((unsigned long) &__heap_base + 63UL) & ~63UL;
+    const ULL end = (ULL) base + bytes;
+    const ULL available = (ULL) __builtin_wasm_memory_size(0) * WASM_PAGE_SIZE;
+    if (end > available && __builtin_wasm_memory_grow(0, (unsigned long) ((end - available + WASM_PAGE_SIZE - 1) / WASM_PAGE_SIZE)) < 0) {
+        return 0;
+    }
+    return (TT_Bucket *) base;
+}
+
+static void ttRelease(TT_Bucket *table) {
+    (void) table;
+}
+#else
+/**
+ * @brief 原生: 按 2MB 对齐分配置换表, Linux 上建议内核用透明大页映射 (置换表访问随机, 大页可减少 TLB 未命中)
+ * @param bytes 需要的字节数
+ * @return 置换表地址 (失败为 NULL)
+ */
+static TT_Bucket *ttAllocate(const ULL bytes) {
+    const size_t alignment = bytes >= TT_ALIGNMENT ? TT_ALIGNMENT : sizeof(TT_Bucket);
+#ifdef _WIN32
+    return (TT_Bucket *) _aligned_malloc((size_t) bytes, alignment);
+#else
+    void *memory;
+    if (posix_memalign(&memory, alignment, (size_t) bytes) != 0) {
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(memory, (size_t) bytes, MADV_HUGEPAGE);
+#endif
+    return (TT_Bucket *) memory;
+#endif
+}
+
+static void ttRelease(TT_Bucket *table) {
+#ifdef _WIN32
+    _aligned_free(table);
+#else
+    free(table);
+#endif
+}
+#endif
+
+#ifndef GOMOKU_WASM
+/**
+ * @brief Zobrist 键的指纹 (写入置换表文件头, 加载时比对)
+ */
+ULL ttZobristCheck() {
+    ULL check = (ULL) BOARD_SIZE;
+    for (int p = 0; p < 3; p++) {
+        for (int i = 0; i < MAX_BOARD_SIZE; i++) {
+            for (int j = 0; j < MAX_BOARD_SIZE; j++) {
+                check = (check ^ gZobristKeys[p][i][j]) * 0x100000001B3ULL;
+            }
+        }
+        check = (check ^ gTtSideKeys[p]) * 0x100000001B3ULL;
+    }
+    return check;
+}
+
+/**
+ * @brief 把映射的置换表写回文件 (记录当前代数, 同步脏页); 置换表不在文件中时什么也不做
+ * @return 1 (已写回) 或 0 (没有映射的文件或同步失败)
+ */
+int ttSaveFile() {
+    if (gTtMapping == NULL) {
+        return 0;
+    }
+    ((TT_FileHeader *) gTtMapping)->generation = gTtGeneration;
+#ifdef _WIN32
+    return FlushViewOfFile(gTtMapping, 0) && FlushFileBuffers(gTtMappingFile);
+#else
+    return msync(gTtMapping, (size_t) gTtMappingBytes, MS_SYNC) == 0;
+#endif
+}
+
+/**
+ * @brief 释放当前置换表 (映射的文件先写回再解除映射, 堆上的表直接释放)
+ */
+void ttReleaseTable() {
+    if (gTtMapping != NULL) {
+        ttSaveFile();
+#ifdef _WIN32
+        UnmapViewOfFile(gTtMapping);
+        CloseHandle(gTtMappingFile);
+#else
+        munmap(gTtMapping, (size_t) gTtMappingBytes);
+#endif
+        gTtMapping = NULL;
+        gTtMappingBytes = 0;
+    } else if (gTtBucketCount > 0) {
+        ttRelease(gTranspositionTable);
+    }
+    gTranspositionTable = NULL;
+    gTtBucketCount = 0;
+    gTtMegabytes = 0;
+}
+
+/**
+ * @brief 把文件映射为置换表 (MAP_SHARED: 条目直接写在文件的页里, 只有访问过的页才会读入内存)
+ * 文件不存在或为空时按当前容量新建 (扩展出的零页即空条目, 无需初始化);
+ * 已有文件必须带有效的文件头且 Zobrist 指纹一致, 否则拒绝 (不会覆盖其他文件)
+ * @param path 文件路径
+ * @param created (出参) 是否为新建的文件
+ * @return 1 (成功, 当前置换表已切换到文件) 或 0 (失败, 当前置换表不变)
+ */
+int ttMapFile(const char *path, int *created) {
+    const ULL newBytes = TT_FILE_HEADER_BYTES + gTtBucketCount * sizeof(TT_Bucket);
+    unsigned char *mapping;
+    ULL bytes;
+
+    // 步骤 1: 打开 (不存在则创建) 并映射整个文件
+#ifdef _WIN32
+    const HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return 0;
+    }
+    *created = size.QuadPart == 0;
+    bytes = *created ? newBytes : (ULL) size.QuadPart;
+    // 映射对象的大小超过文件时, 文件会被扩展 (扩展部分读出为 0)
+    const HANDLE mappingObject = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD) (bytes >> 32), (DWORD) bytes, NULL);
+    if (mappingObject == NULL) {
+        CloseHandle(file);
+        return 0;
+    }
+    mapping = (unsigned char *) MapViewOfFile(mappingObject, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T) bytes);
+    CloseHandle(mappingObject); // 视图仍然保持映射对象
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return 0;
+    }
+#else
+    const int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        close(fd);
+        return 0;
+    }
+    *created = status.st_size == 0;
+    bytes = *created ? newBytes : (ULL) status.st_size;
+    if (*created && ftruncate(fd, (off_t) bytes) != 0) {
+        close(fd);
+        return 0;
+    }
+    void *view = mmap(NULL, (size_t) bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // 映射不依赖文件描述符
+    if (view == MAP_FAILED) {
+        return 0;
+    }
+    mapping = (unsigned char *) view;
+#ifdef MADV_RANDOM
+    madvise(mapping, (size_t) bytes, MADV_RANDOM); // 置换表访问随机, 不做预读
+#endif
+#endif
+
+    // 步骤 2: 新文件写入文件头; 已有文件检查文件头
+    TT_FileHeader *header = (TT_FileHeader *) mapping;
+    if (*created) {
+        header->magic = TT_FILE_MAGIC;
+        header->bucketCount = gTtBucketCount;
+        header->zobristCheck = ttZobristCheck();
+        header->bucketBytes = (int) sizeof(TT_Bucket);
+        header->generation = gTtGeneration;
+    } else {
+        const ULL count = bytes >= TT_FILE_HEADER_BYTES ? header->bucketCount : 0;
+        const int valid = bytes >= TT_FILE_HEADER_BYTES && header->magic == TT_FILE_MAGIC && header->bucketBytes == (int) sizeof(TT_Bucket)
+                          && header->zobristCheck == ttZobristCheck() && count > 0 && (count & (count - 1)) == 0
+                          && TT_FILE_HEADER_BYTES + count * sizeof(TT_Bucket) == bytes;
+        if (!valid) {
+#ifdef _WIN32
+            UnmapViewOfFile(mapping);
+            CloseHandle(file);
+#else
+            munmap(mapping, (size_t) bytes);
+#endif
+            return 0;
+        }
+    }
+
+    // 步骤 3: 切换当前置换表 (旧表释放; 代数从文件中记录的值继续, 文件里的条目都属于旧代)
+    const ULL bucketCount = header->bucketCount;
+    const int generation = header->generation;
+    ttReleaseTable();
+    gTtMapping = mapping;
+    gTtMappingBytes = bytes;
+#ifdef _WIN32
+    gTtMappingFile = file;
+#endif
+    gTranspositionTable = (TT_Bucket *) (mapping + TT_FILE_HEADER_BYTES);
+    gTtBucketCount = bucketCount;
+    gTtMegabytes = (int) (bucketCount * sizeof(TT_Bucket) >> 20);
+    gTtGeneration = generation;
+    return 1;
+}
+#else
+void ttReleaseTable() {
+    if (gTtBucketCount > 0) {
+        ttRelease(gTranspositionTable);
+    }
+    gTranspositionTable = 0;
+    gTtBucketCount = 0;
+    gTtMegabytes = 0;
+}
+#endif
+
+/**
+ * @brief 按容量重新分配并清空置换表 (只能在没有搜索运行时调用)
+ * 桶数取不超过容量的最大 2 的幂; 分配失败时容量逐次减半
+ * @param megabytes 容量 (MB, 限制在 [1, TT_MAX_MB])
+ * @return 实际使用的容量 (MB); 连 1MB 都无法分配时为 0
+ */
+int ttResize(const int megabytes) {
+    int size = megabytes < 1 ? 1 : megabytes > TT_MAX_MB ? TT_MAX_MB : megabytes;
+
+    // 步骤 1: 先释放旧表 (大表换大表时避免同时占用两份内存; 映射的文件先写回再解除映射)
+    ttReleaseTable();
+
+    // 步骤 2: 分配新表, 失败时减半重试
+    while (size > 0) {
+        ULL buckets = 1;
+        while (buckets * 2 * sizeof(TT_Bucket) <= (ULL) size << 20) {
+            buckets *= 2;
+        }
+        TT_Bucket *table = ttAllocate(buckets * sizeof(TT_Bucket));
+        if (table != 0) {
+            gTranspositionTable = table;
+            gTtBucketCount = buckets;
+            gTtMegabytes = size;
+            clearTranspositionTable();
+            return size;
+        }
+        size /= 2;
+    }
+    return 0;
+}
+
+#ifndef GOMOKU_WASM
+/**
+ * @brief 换下的对局置换表 (临时表使用期间保存, 映射的文件也原样保留)
+ */
+typedef struct {
+    TT_Bucket *table;
+    ULL bucketCount;
+    int megabytes;
+    int generation;
+} TT_SavedTable;
+
+/**
+ * @brief 把置换表临时换成堆上一张新的空表 (诊断命令使用, 对局的置换表与映射的文件都不会被读写)
+ * @param saved (出参) 换下的对局置换表, 交给 ttRestoreTable 换回
+ * @param megabytes 临时表的容量 (MB, 桶数取不超过容量的最大 2 的幂)
+ * @return 1 (成功) 或 0 (分配失败, 置换表保持不变)
+ */
+int ttUseScratchTable(TT_SavedTable *saved, const int megabytes) {
+    ULL buckets = 1;
+    while (buckets * 2 * sizeof(TT_Bucket) <= (ULL) (megabytes < 1 ? 1 : megabytes) << 20) {
+        buckets *= 2;
+    }
+    TT_Bucket *table = ttAllocate(buckets * sizeof(TT_Bucket));
+    if (table == NULL) {
+        return 0;
+    }
+    saved->table = gTranspositionTable;
+    saved->bucketCount = gTtBucketCount;
+    saved->megabytes = gTtMegabytes;
+    saved->generation = gTtGeneration;
+    gTranspositionTable = table;
+    gTtBucketCount = buckets;
+    gTtMegabytes = megabytes < 1 ? 1 : megabytes; // 临时表使用期间报告的容量也是临时表的
+    clearTranspositionTable();
+    return 1;
+}
+
+/**
+ * @brief 释放临时表, 换回 ttUseScratchTable 保存的对局置换表
+ */
+void ttRestoreTable(const TT_SavedTable *saved) {
+    ttRelease(gTranspositionTable);
+    gTranspositionTable = saved->table;
+    gTtBucketCount = saved->bucketCount;
+    gTtMegabytes = saved->megabytes;
+    gTtGeneration = saved->generation;
+}
+#endif
+
 /**
  * @brief 初始化 Zobrist 哈希键表和置换表
  */
@@ -245,44 +894,139 @@ void ttInit(ULL seed) {
         }
     }
 
-    // 步骤 6: 将全局置换表切换到静态存储并清零
-    gTranspositionTable = gTranspositionTableStorage;
-    clearTranspositionTable();
+    // 步骤 6: 首次初始化时按默认容量分配置换表, 之后只清零
+    if (gTtBucketCount == 0) {
+        ttResize(TT_DEFAULT_MB);
+    } else {
+        clearTranspositionTable();
+    }
+
+    // 步骤 7: VCF 缓存使用同一套 Zobrist 键, 另外为攻方生成标记并清空缓存
+    for (int p = 0; p < 3; p++) {
+        gVcfAttackerKeys[p] = genU64Rand();
+    }
+    gDfpnAndKey = genU64Rand();
+    for (int p = 0; p < 3; p++) {
+        gTtSideKeys[p] = genU64Rand();
+    }
+    for (int i = 0; i < VCF_CACHE_SIZE; i++) {
+        gVcfCache[i].key = 0;
+        gVcfCache[i].depth = 0;
+    }
+    for (int i = 0; i < VCT_CACHE_SIZE; i++) {
+        gVctCache[i].key = 0;
+        gVctCache[i].depth = 0;
+    }
+}
+
+/**
+ * @brief 把搜索分数编码为 32 位
+ * 普通分数 (绝对值不超过 TT_SCORE_LIMIT) 原样存储; 胜负分 (距 SCORE_MAX/SCORE_MIN 不超过 TT_MATE_RANGE) 映射到编码区两端
+ * @param score 搜索分数
+ * @param code (出参) 32 位编码
+ * @return 1 (可以精确表示) 或 0 (普通分数超出范围, 调用方需按界处理)
+ */
+int ttEncodeScore(const LL score, int *code) {
+    if (score >= SCORE_MAX - TT_MATE_RANGE) {
+        *code = (int) (0x7FFFFFFFLL - (SCORE_MAX - score));
+        return 1;
+    }
+    if (score <= SCORE_MIN + TT_MATE_RANGE) {
+        *code = (int) (-0x7FFFFFFFLL + (score - SCORE_MIN));
+        return 1;
+    }
+    if (score > TT_SCORE_LIMIT || score < -TT_SCORE_LIMIT) {
+        return 0;
+    }
+    *code = (int) score;
+    return 1;
+}
+
+/**
+ * @brief 把 32 位编码还原为搜索分数 (ttEncodeScore 的逆运算)
+ */
+LL ttDecodeScore(const int code) {
+    if (code > TT_SCORE_LIMIT) {
+        return SCORE_MAX - (0x7FFFFFFFLL - code);
+    }
+    if (code < -TT_SCORE_LIMIT) {
+        return SCORE_MIN + ((LL) code + 0x7FFFFFFFLL);
+    }
+    return code;
+}
+
+/**
+ * @brief 打包置换表条目的内容 (位布局见 TT_Entry)
+ */
+ULL ttPackData(const int scoreCode, const int move, const int depth, const int type, const int age) {
+    return (ULL) (unsigned int) scoreCode | (ULL) ((move + 1) & 0xFFFF) << 32 | (ULL) (depth & 0xFF) << 48 | (ULL) ((type ^ TT_TYPE_NONE) & 3) << 56 | (ULL) (age & 0x3F) << 58;
+}
+
+int ttDataMove(const ULL data) {
+    return (int) (data >> 32 & 0xFFFF) - 1; // 0 还原为 MOVE_NONE
+}
+
+int ttDataDepth(const ULL data) {
+    return (int) (data >> 48 & 0xFF);
+}
+
+int ttDataType(const ULL data) {
+    return (int) (data >> 56 & 3) ^ TT_TYPE_NONE;
+}
+
+int ttDataAge(const ULL data) {
+    return (int) (data >> 58);
 }
 
 /**
  * @brief 从置换表查询
- * @param key 当前 Zobrist 哈希
+ * @param hash 当前 Zobrist 哈希 (查询时再混入 AI 一方的键)
  * @param depth 当前搜索深度 (剩余深度)
  * @param alpha 当前 Alpha 值
  * @param beta 当前 Beta 值
+ * @param hashMove (出参) 键匹配时返回存储的最佳着法 (即使深度不足也可用于着法排序), 否则为 MOVE_NONE
  * @return 查找到的分数，如果未命中或深度不足则返回 SCORE_MIN - 1
  */
-LL ttSearch(const ULL key, const int depth, const LL alpha, const LL beta) {
-    // 步骤 1: 计算哈希键在表中的索引 (使用取模)
-    const TT_Entry *entry = &gTranspositionTable[key % TT_SIZE];
+LL ttSearch(const ULL hash, const int depth, const LL alpha, const LL beta, int *hashMove) {
+    const ULL key = hash ^ gTtSideKeys[gAiPlayerId];
+    // 步骤 1: 用掩码取桶, 在桶内查找键匹配的条目 (两个字各自原子读取, 其他线程可能同时在写)
+    const TT_Bucket *bucket = &gTranspositionTable[key & (gTtBucketCount - 1)];
+    *hashMove = MOVE_NONE;
+    for (int k = 0; k < TT_BUCKET_SIZE; k++) {
+        const ULL data = __atomic_load_n(&bucket->entries[k].data, __ATOMIC_RELAXED);
+        const ULL keyXorData = __atomic_load_n(&bucket->entries[k].keyXorData, __ATOMIC_RELAXED);
+        // 检查 Zobrist 键是否匹配 (防止哈希碰撞与并发写坏的条目)
+        if ((keyXorData ^ data) != key) {
+            continue;
+        }
+        *hashMove = ttDataMove(data);
+
+        // 步骤 2: 检查存储的深度是否 >= 当前深度 (存储的结果是否足够好)
+        const int type = ttDataType(data);
+        if (ttDataDepth(data) < depth || type == TT_TYPE_NONE) {
+            break;
+        }
+        const LL score = ttDecodeScore((int) (unsigned int) data);
 
-    // 步骤 2: 检查 Zobrist 键是否匹配 (防止哈希碰撞)
-    // 并检查存储的深度是否 >= 当前深度 (存储的结果是否足够好)
-    if (entry->key == key && entry->depth >= depth) {
         // 步骤 3: 命中，根据存储的类型返回分数
 
         // 类型 3a: 精确值 (TT_TYPE_EXACT)
         // 存储的分数是 [alpha, beta] 范围内的精确值
-        if (entry->type == TT_TYPE_EXACT)
-            return entry->score;
+        if (type == TT_TYPE_EXACT)
+            return score;
 
-        // 类型 3b: Alpha 值 (下界, TT_TYPE_ALPHA)
-        // 存储的分数是 "至少" (>=) entry->score, 且它导致了 Alpha 剪枝
-        // 如果存储的下界 (entry->score) 已经小于等于我们当前的 alpha, 它仍然有用
-        if (entry->type == TT_TYPE_ALPHA && entry->score <= alpha)
+        // 类型 3b: Alpha 值 (上界, TT_TYPE_ALPHA)
+        // 存储的分数是 "至多" (<=) score
+        // 如果存储的上界 (score) 已经小于等于我们当前的 alpha, 它仍然有用
+        if (type == TT_TYPE_ALPHA && score <= alpha)
             return alpha;
 
-        // 类型 3c: Beta 值 (上界, TT_TYPE_BETA)
-        // 存储的分数是 "至多" (<=) entry->score, 且它导致了 Beta 剪枝
-        // 如果存储的上界 (entry->score) 已经大于等于我们当前的 beta, 它仍然有用
-        if (entry->type == TT_TYPE_BETA && entry->score >= beta)
+        // 类型 3c: Beta 值 (下界, TT_TYPE_BETA)
+        // 存储的分数是 "至少" (>=) score, 且它导致了 Beta 剪枝
+        // 如果存储的下界 (score) 已经大于等于我们当前的 beta, 它仍然有用
+        if (type == TT_TYPE_BETA && score >= beta)
             return beta;
+        break;
     }
 
     // 步骤 4: 未命中或深度不足, 返回一个特殊值表示 "没找到"
@@ -291,60 +1035,201 @@ LL ttSearch(const ULL key, const int depth, const LL alpha, const LL beta) {
 
 /**
  * @brief 存储到置换表
- * @param key Zobrist 哈希
+ * @param hash Zobrist 哈希 (存储时再混入 AI 一方的键)
  * @param depth 搜索深度 (剩余深度)
  * @param score 评估分数
- * @param type 条目类型 (EXACT, ALPHA, BETA)
+ * @param type 分数类型 (EXACT, ALPHA, BETA)
+ * @param move 最佳着法 (MOVE_NONE 表示无)
  */
-void ttStore(const ULL key, const int depth, const LL score, const int type) {
-    // 步骤 1: 计算哈希键在表中的索引
-    TT_Entry *entry = &gTranspositionTable[key % TT_SIZE];
+void ttStore(const ULL hash, const int depth, const LL score, int type, const int move) {
+    const ULL key = hash ^ gTtSideKeys[gAiPlayerId];
+    // 步骤 1: 用掩码取桶, 选择要写入的条目
+    // 同一局面的条目优先; 否则替换价值最低的条目: 之前的决策留下的条目先于本次的, 同代中浅的先于深的
+    TT_Bucket *bucket = &gTranspositionTable[key & (gTtBucketCount - 1)];
+    const int age = gTtGeneration & 0x3F;
+    TT_Entry *target = &bucket->entries[0];
+    int targetValue = 0x7FFFFFFF;
+    ULL old = 0;
+    int sameKey = 0;
+    for (int k = 0; k < TT_BUCKET_SIZE; k++) {
+        TT_Entry *entry = &bucket->entries[k];
+        const ULL data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+        if ((__atomic_load_n(&entry->keyXorData, __ATOMIC_RELAXED) ^ data) == key) {
+            target = entry;
+            old = data;
+            sameKey = 1;
+            break;
+        }
+        const int value = ttDataDepth(data) + (ttDataAge(data) == age ? 256 : 0);
+        if (value < targetValue) {
+            target = entry;
+            targetValue = value;
+            old = data;
+        }
+    }
+
+    // 步骤 2: 同一局面: 本次决策中更深的结果不被较浅的结果覆盖
+    if (sameKey && ttDataAge(old) == age && ttDataDepth(old) > depth) {
+        return;
+    }
 
-    // 步骤 2: 替换策略 (深度优先)
-    // 仅当新条目的深度 >= 旧条目时才覆盖
-    // (来自更深搜索的结果通常更准确)
-    if (entry->depth <= depth) {
-        // 步骤 3: 存储所有信息
-        entry->key = key; // 存储 Zobrist 键 (用于碰撞检测)
-        entry->depth = depth; // 存储搜索深度
-        entry->score = score; // 存储评估分
-        entry->type = type; // 存储分数类型
+    // 步骤 3: 分数编码为 32 位; 超出范围的普通分数退化为同方向的界 (仍然正确, 只是更保守), 无法表示时只保存着法
+    int scoreCode;
+    if (!ttEncodeScore(score, &scoreCode)) {
+        if (score > 0 && type != TT_TYPE_ALPHA) {
+            scoreCode = (int) TT_SCORE_LIMIT;
+            type = TT_TYPE_BETA;
+        } else if (score < 0 && type != TT_TYPE_BETA) {
+            scoreCode = (int) -TT_SCORE_LIMIT;
+            type = TT_TYPE_ALPHA;
+        } else {
+            scoreCode = 0;
+            type = TT_TYPE_NONE;
+        }
     }
+
+    // 步骤 4: 同一局面的新结果没有着法 (例如叶节点) 时, 保留旧的最佳着法
+    const int storedMove = move != MOVE_NONE || !sameKey ? move : ttDataMove(old);
+
+    // 步骤 5: 存储打包的内容与校验后的 Zobrist 键 (用于碰撞检测; 两次原子写之间被读到也只会校验失败)
+    const ULL data = ttPackData(scoreCode, storedMove, depth, type, age);
+    __atomic_store_n(&target->data, data, __ATOMIC_RELAXED);
+    __atomic_store_n(&target->keyXorData, key ^ data, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 为新一次决策准备置换表: 代数加一 (O(1), 上一步的条目保留下来继续命中, 但会被本次的条目逐步替换)
+ * (AI 换边时分数的含义反转, 但键中混入了 AI 一方, 两边的条目不会互相命中, 同样无需清空)
+ */
+void ttNewSearch() {
+    gTtGeneration++;
 }
 
 // --- 棋盘状态管理 --- //
 
 /**
- * @brief 初始化棋盘 (设置开局棋子并计算初始哈希)
- * @param board 指向要初始化的棋盘
+ * @brief 对坐标施加对称变换 (先按 bit 2 转置, 再按 bit 0 / bit 1 翻转行 / 列)
+ * @param symmetry 变换编号 (0 为恒等变换)
+ * @param row (出入参) 行
+ * @param col (出入参) 列
+ * @param inverse 1 表示施加逆变换 (先翻转再转置)
  */
-void boardInit(ChessBoard *board) {
-#ifdef GOMOKU_WASM
-    clearBoard(board);
-#else
-    clearBoard(board);
+void symmetryApply(const int symmetry, int *row, int *col, const int inverse) {
+    const int last = BOARD_SIZE - 1;
+    int r = *row;
+    int c = *col;
+    if ((symmetry & 4) && !inverse) {
+        const int t = r;
+        r = c;
+        c = t;
+    }
+    if (symmetry & 1) {
+        r = last - r;
+    }
+    if (symmetry & 2) {
+        c = last - c;
+    }
+    if ((symmetry & 4) && inverse) {
+        const int t = r;
+        r = c;
+        c = t;
+    }
+    *row = r;
+    *col = c;
+}
 
-    // 原生命令行模式保持最初的中心四子开局
-    const int centerA = (BOARD_SIZE + 1) / 2 - 1;
-    const int centerB = BOARD_SIZE / 2;
-
-    board->layout[centerA][centerA] = PIECE_W;
-    board->layout[centerB][centerB] = PIECE_W;
-    board->layout[centerB][centerA] = PIECE_B;
-    board->layout[centerA][centerB] = PIECE_B;
+/**
+ * @brief 找出保持当前局面不变的对称变换 (开局的空棋盘, 中心单子与中心四子等局面是对称的)
+ * @param board (只读) 棋盘状态
+ * @return 位掩码: bit s 置位表示变换 s 把局面映射为自身 (bit 0 恒为 1)
+ */
+int boardSymmetryMask(const ChessBoard *board) {
+    int mask = 1;
+    for (int s = 1; s < SYMMETRY_COUNT; s++) {
+        int same = 1;
+        for (int i = 0; i < BOARD_SIZE && same; i++) {
+            for (int j = 0; j < BOARD_SIZE && same; j++) {
+                int r = i;
+                int c = j;
+                symmetryApply(s, &r, &c, 0);
+                same = board->cells[CELL_INDEX(r, c)] == board->cells[CELL_INDEX(i, j)];
+            }
+        }
+        if (same) {
+            mask |= 1 << s;
+        }
+    }
+    return mask;
+}
 
+/**
+ * @brief 按棋盘内容重新计算 8 个对称哈希 (开启对称模式或初始化棋盘时调用)
+ * @param board 指向棋盘
+ */
+void boardRehashSymmetry(ChessBoard *board) {
+    for (int s = 0; s < SYMMETRY_COUNT; s++) {
+        board->symmetryHashes[s] = 0;
+    }
     for (int i = 0; i < BOARD_SIZE; i++) {
         for (int j = 0; j < BOARD_SIZE; j++) {
-            if (board->layout[i][j] != EMPTY_SLOT) {
-                board->currentHash ^= gZobristKeys[board->layout[i][j]][i][j];
+            if (board->cells[CELL_INDEX(i, j)] == EMPTY_SLOT) {
+                continue;
+            }
+            for (int s = 0; s < SYMMETRY_COUNT; s++) {
+                int r = i;
+                int c = j;
+                symmetryApply(s, &r, &c, 0);
+                board->symmetryHashes[s] ^= gZobristKeys[board->cells[CELL_INDEX(i, j)]][r][c];
             }
         }
     }
-#endif
+}
+
+void boardUpdateEvaluation(ChessBoard *board, int row, int col, int piece);
+
+/**
+ * @brief 只改写一格的棋子与线编码, 不更新哈希与评估
+ * (boardUpdate 的一部分; 也用于 VCT 的试探落子: 之后只做棋型与成五查询, 并且会原样恢复)
+ * @param board 指向棋盘
+ * @param row 行
+ * @param col 列
+ * @param piece 棋子 (EMPTY_SLOT, PIECE_B, PIECE_W)
+ */
+void boardProbeCell(ChessBoard *board, const int row, const int col, const int piece) {
+    board->cells[CELL_INDEX(row, col)] = piece;
+    for (int d = 0; d < 4; d++) {
+        int line, pos;
+        lineLocate(d, row, col, &line, &pos);
+        const int shift = 2 * (pos + LINE_WINDOW);
+        board->lineCodes[line] = (board->lineCodes[line] & ~(3ULL << shift)) | (ULL) piece << shift;
+    }
+}
+
+/**
+ * @brief 取 (row, col) 在方向 d 上的线编码窗口 (线上第 pos + k 格位于第 2 * (k + LINE_WINDOW) 位, k >= -LINE_WINDOW)
+ */
+static inline ULL lineWindow(const ChessBoard *board, const int d, const int row, const int col) {
+    int line, pos;
+    lineLocate(d, row, col, &line, &pos);
+    return board->lineCodes[line] >> 2 * pos;
+}
+
+/**
+ * @brief 从线编码中取出 player 的棋子位 (每格只保留低位: 该格是 player 的棋子时为 1)
+ */
+static inline ULL lineStoneBits(const ULL codes, const int player) {
+    return (player == PIECE_B ? codes & ~(codes >> 1) : codes >> 1 & ~codes) & LINE_LOW_BITS;
+}
+
+/**
+ * @brief 从线编码中取出有棋子的格 (黑或白, 不含界外)
+ */
+static inline ULL lineOccupiedBits(const ULL codes) {
+    return (codes ^ codes >> 1) & LINE_LOW_BITS;
 }
 
 /**
- * @brief 更新棋盘 (用于落子或悔棋)，增量更新 Zobrist 哈希
+ * @brief 更新棋盘 (用于落子或悔棋)，增量更新 Zobrist 哈希与评估
  * @param board 指向要更新的棋盘
  * @param row 行
  * @param col 列
@@ -354,70 +1239,123 @@ void boardUpdate(ChessBoard *board, const int row, const int col, const int piec
     // Zobrist 哈希的增量更新
 
     // 步骤 1: "移除" (异或掉) (row, col) 位置上 *旧* 棋子状态的哈希值
-    board->currentHash ^= gZobristKeys[board->layout[row][col]][row][col];
+    board->currentHash ^= gZobristKeys[board->cells[CELL_INDEX(row, col)]][row][col];
 
     // 步骤 2: "添加" (异或上) (row, col) 位置上 *新* 棋子状态的哈希值
     board->currentHash ^= gZobristKeys[piece][row][col];
 
-    // 步骤 3: 实际更新棋盘数组
-    board->layout[row][col] = piece;
-}
+    // 步骤 3: 对称模式下同样增量更新 8 个对称哈希 (变换 s 的哈希使用变换后坐标上的键)
+    if (gSymmetryHash) {
+        for (int s = 0; s < SYMMETRY_COUNT; s++) {
+            int r = row;
+            int c = col;
+            symmetryApply(s, &r, &c, 0);
+            board->symmetryHashes[s] ^= gZobristKeys[board->cells[CELL_INDEX(row, col)]][r][c] ^ gZobristKeys[piece][r][c];
+        }
+    }
 
-// --- 棋局评估函数 --- //
+    // 步骤 4: 实际更新棋盘数组与 4 个方向的线编码, 同时增量更新评估 (只重新分析经过 (row, col) 的 4 条线上的棋子)
+    boardUpdateEvaluation(board, row, col, piece);
+}
 
 /**
- * @brief 加载棋型得分 (初始化 gPatternScores)
+ * @brief 初始化棋盘 (设置开局棋子; 哈希与评估由 boardUpdate 计算)
+ * @param board 指向要初始化的棋盘
  */
-void loadPatternScores() {
-    // 步骤 1: 确保全局表在初始化前是干净的
-    clearPatternTable(&gPatternScores);
+void boardInit(ChessBoard *board) {
+#ifdef GOMOKU_WASM
+    clearBoard(board);
+#else
+    clearBoard(board);
 
-    // 步骤 2: 初始化 AI (我方) 的棋型得分 (使用宏定义的分数)
-    gPatternScores.AIFitting[PATTERN_FIVE] = SCORE_FIVE;
-    gPatternScores.AIFitting[PATTERN_FOUR_OPEN] = SCORE_FOUR_OPEN;
-    gPatternScores.AIFitting[PATTERN_THREE_OPEN] = SCORE_THREE_OPEN;
-    gPatternScores.AIFitting[PATTERN_FOUR_RUSH] = SCORE_FOUR_RUSH;
-    gPatternScores.AIFitting[PATTERN_JUMP_FOUR_OPEN] = SCORE_JUMP_FOUR_OPEN;
-    gPatternScores.AIFitting[PATTERN_JUMP_THREE_OPEN] = SCORE_JUMP_THREE_OPEN;
-    gPatternScores.AIFitting[PATTERN_JUMP_FOUR_SLEEP] = SCORE_JUMP_FOUR_SLEEP;
-    gPatternScores.AIFitting[PATTERN_TWO_OPEN] = SCORE_TWO_OPEN;
-    gPatternScores.AIFitting[PATTERN_THREE_SLEEP] = SCORE_THREE_SLEEP;
-    gPatternScores.AIFitting[PATTERN_TWO_SLEEP] = SCORE_TWO_SLEEP;
-    gPatternScores.AIFitting[PATTERN_INVALID] = SCORE_INVALID;
+    // 原生命令行模式保持最初的中心四子开局 (经 boardUpdate 落子, 哈希与评估随之更新)
+    const int centerA = (BOARD_SIZE + 1) / 2 - 1;
+    const int centerB = BOARD_SIZE / 2;
 
-    // 步骤 3: 动态计算对手的棋型分数
-    for (int i = 0; i < PATTERN_COUNT; i++) {
-        // 计算对手的棋型分数 (将 AI 的分数乘以一个权重)
-        gPatternScores.OppFitting[i] = gPatternScores.AIFitting[i] * PATTERN_WEIGHT;
-    }
+    boardUpdate(board, centerA, centerA, PIECE_W);
+    boardUpdate(board, centerB, centerB, PIECE_W);
+    boardUpdate(board, centerB, centerA, PIECE_B);
+    boardUpdate(board, centerA, centerB, PIECE_B);
+#endif
 }
 
 /**
- * @brief 评估在单一方向上的棋子布局 (analyzeLine 的辅助函数)
+ * @brief 置换表使用的局面哈希: 对称模式下取 8 个对称哈希中最小的一个 (规范局面), 否则即 currentHash
  * @param board (只读) 棋盘状态
- * @param pos 评估的中心点 (不搜索此点, 而是从此点的 *下一个* 点开始)
- * @param dRow 行方向向量 (例如 1, 0, -1)
- * @param dCol 列方向向量 (例如 1, 0, -1)
+ * @param symmetry (出参) 把当前局面变换为规范局面的对称变换编号
+ * @return 置换表哈希
+ */
+ULL boardTtHash(const ChessBoard *board, int *symmetry) {
+    *symmetry = 0;
+    if (!gSymmetryHash) {
+        return board->currentHash;
+    }
+    ULL hash = board->symmetryHashes[0];
+    for (int s = 1; s < SYMMETRY_COUNT; s++) {
+        if (board->symmetryHashes[s] < hash) {
+            hash = board->symmetryHashes[s];
+            *symmetry = s;
+        }
+    }
+    return hash;
+}
+
+/**
+ * @brief 对置换表中的着法编号施加对称变换 (MOVE_NONE 保持不变)
+ */
+int symmetryMove(const int symmetry, const int move, const int inverse) {
+    if (move == MOVE_NONE || symmetry == 0) {
+        return move;
+    }
+    int row = move / MAX_BOARD_SIZE;
+    int col = move % MAX_BOARD_SIZE;
+    symmetryApply(symmetry, &row, &col, inverse);
+    return row * MAX_BOARD_SIZE + col;
+}
+
+/**
+ * @brief 按棋盘查询置换表 (对称模式下查询规范局面, 存储的着法变换回当前局面的坐标)
+ * 参数与返回值同 ttSearch
+ */
+LL ttSearchBoard(const ChessBoard *board, const int depth, const LL alpha, const LL beta, int *hashMove) {
+    int symmetry;
+    const LL score = ttSearch(boardTtHash(board, &symmetry), depth, alpha, beta, hashMove);
+    *hashMove = symmetryMove(symmetry, *hashMove, 1);
+    return score;
+}
+
+/**
+ * @brief 按棋盘存储到置换表 (对称模式下存入规范局面, 着法变换为规范局面的坐标)
+ * 参数同 ttStore
+ */
+void ttStoreBoard(const ChessBoard *board, const int depth, const LL score, const int type, const int move) {
+    int symmetry;
+    const ULL hash = boardTtHash(board, &symmetry);
+    ttStore(hash, depth, score, type, symmetryMove(symmetry, move, 0));
+}
+
+// --- 棋局评估函数 --- //
+
+/**
+ * @brief 评估在单一方向上的棋子布局 (classifyLine 的辅助函数)
+ * @param cells 从中心点的 *下一个* 点起沿该方向的 LINE_WINDOW 格 (EMPTY_SLOT, PIECE_B, PIECE_W 或 CELL_WALL)
  * @param player 评估的玩家
  * @return LineSearchResult 包含该方向搜索结果的结构体
  */
-LineSearchResult searchDirection(const ChessBoard *board, const Coord pos, const int dRow, const int dCol, const int player) {
+LineSearchResult searchDirection(const unsigned char *cells, const int player) {
     // 步骤 1: 初始化所有返回值为 0
     LineSearchResult result = {0, 0, 0, 0, 0};
     const int oppPlayer = player == 1 ? 2 : 1;
 
-    // 步骤 2: 确定起始搜索位置 (中心点的下一个)
-    int checkRow = pos.row + dRow;
-    int checkCol = pos.col + dCol;
-
     int foundGap = 0; // 是否找到了一个空档
     int isJumping = 0; // 是否正在跳跃
 
-    // 步骤 3: 循环搜索, 直到出界
-    while (checkRow >= 0 && checkRow < BOARD_SIZE && checkCol >= 0 && checkCol < BOARD_SIZE) {
-        // 步骤 3a: 刚找到空档 (foundGap=1) 且还未开始跳跃 (isJumping=0)
+    // 步骤 2: 循环搜索, 直到出界 (窗口之外的格不影响棋型, 见 buildLinePatternTable)
+    for (int k = 0; k < LINE_WINDOW && cells[k] != CELL_WALL; k++) {
+        const int cell = cells[k];
+        // 步骤 2a: 刚找到空档 (foundGap=1) 且还未开始跳跃 (isJumping=0)
         if (foundGap && !isJumping) {
-            if (board->layout[checkRow][checkCol] == player) {
+            if (cell == player) {
                 // 找到了空档后的第一个己方棋子, 开始 "跳跃"
                 isJumping = 1;
                 result.jumpCount++;
@@ -426,12 +1364,12 @@ LineSearchResult searchDirection(const ChessBoard *board, const Coord pos, const
                 break;
             }
 
-            // 步骤 3b: 正在跳跃中 (isJumping=1)
+            // 步骤 2b: 正在跳跃中 (isJumping=1)
         } else if (isJumping && foundGap) {
-            if (board->layout[checkRow][checkCol] == player) {
+            if (cell == player) {
                 // 连续的跳跃棋子
                 result.jumpCount++;
-            } else if (board->layout[checkRow][checkCol] == oppPlayer) {
+            } else if (cell == oppPlayer) {
                 // 跳跃被对手阻挡
                 result.jumpBlocked = 1;
                 break;
@@ -441,13 +1379,13 @@ LineSearchResult searchDirection(const ChessBoard *board, const Coord pos, const
                 break;
             }
 
-            // 步骤 3c: 尚未找到空档 (标准连续棋子)
+            // 步骤 2c: 尚未找到空档 (标准连续棋子)
         } else {
-            if (board->layout[checkRow][checkCol] == EMPTY_SLOT) {
+            if (cell == EMPTY_SLOT) {
                 // 第一次遇到空
                 result.openEnd = 1; // 标记此方向为 "开放"
                 foundGap = 1; // 标记已找到空档
-            } else if (board->layout[checkRow][checkCol] != player) {
+            } else if (cell != player) {
                 // 被对手阻挡, 停止
                 break;
             } else {
@@ -455,31 +1393,25 @@ LineSearchResult searchDirection(const ChessBoard *board, const Coord pos, const
                 result.consecutiveCount++;
             }
         }
-
-        // 移动到下一个位置
-        checkRow += dRow;
-        checkCol += dCol;
     }
 
-    // 步骤 4: 返回该方向的搜索结果
+    // 步骤 3: 返回该方向的搜索结果
     return result;
 }
 
 /**
- * @brief 分析单个点在单个方向上的棋型 (核心评估逻辑)
- * @param board (只读) 棋盘状态
- * @param pos 评估的中心点 (假定该点已被 player 占据)
- * @param dRow 行方向向量 (基础方向, 例如 1, 0, 1, 1)
- * @param dCol 列方向向量 (基础方向, 例如 0, 1, 1, -1)
- * @param player 评估的玩家
+ * @brief 由中心点两侧的格分类棋型 (核心评估逻辑; 只在生成 gLinePatternTable 时调用)
+ * @param fwdCells 正向的 LINE_WINDOW 格 (由近及远)
+ * @param bwdCells 反向的 LINE_WINDOW 格 (由近及远)
+ * @param player 评估的玩家 (假定中心点已被 player 占据)
  * @return 识别到的棋型 (PatternType)
  */
-int analyzeLine(const ChessBoard *board, const Coord pos, const int dRow, const int dCol, const int player) {
-    // --- 步骤 1: 正向搜索 (dRow, dCol) ---
-    const LineSearchResult fwd = searchDirection(board, pos, dRow, dCol, player);
+int classifyLine(const unsigned char *fwdCells, const unsigned char *bwdCells, const int player) {
+    // --- 步骤 1: 正向搜索 ---
+    const LineSearchResult fwd = searchDirection(fwdCells, player);
 
-    // --- 步骤 2: 反向搜索 (-dRow, -dCol) ---
-    const LineSearchResult bwd = searchDirection(board, pos, -dRow, -dCol, player);
+    // --- 步骤 2: 反向搜索 ---
+    const LineSearchResult bwd = searchDirection(bwdCells, player);
 
     // --- 步骤 3: 合并结果 ---
 
@@ -530,26 +1462,87 @@ int analyzeLine(const ChessBoard *board, const Coord pos, const int dRow, const
     return PATTERN_INVALID;
 }
 
+
 /**
- * @brief 评估单个玩家在某个点上的威胁 (计算该点在4个方向上的棋型总分)
- * (此函数用于 evaluateBoardScore, 评估 *已存在* 的棋子)
+ * @brief 生成棋型查找表 (启动时生成一次)
+ * 中心点两侧各 LINE_WINDOW 格就能确定 analyzeLine 的结果: 扫描只有在己方连子 + 空档 + 跳跃棋子超过 4 颗时
+ * 才会读到更远的格, 而此时连子或 "连子 + 跳跃" 已超过 4 颗, 结果与更远的格无关
+ */
+void buildLinePatternTable() {
+    unsigned char fwd[LINE_WINDOW];
+    unsigned char bwd[LINE_WINDOW];
+    for (int code = 0; code < 1 << (4 * LINE_WINDOW); code++) {
+        // 编码: 低 2 * LINE_WINDOW 位为反向的格 (最近的一格在最高位), 其上为正向的格 (最近的一格在最低位)
+        for (int k = 0; k < LINE_WINDOW; k++) {
+            bwd[k] = (unsigned char) (code >> 2 * (LINE_WINDOW - 1 - k) & 3);
+            fwd[k] = (unsigned char) (code >> 2 * (LINE_WINDOW + k) & 3);
+        }
+        gLinePatternTable[code] = (unsigned char) (classifyLine(fwd, bwd, PIECE_B) | classifyLine(fwd, bwd, PIECE_W) << 4);
+    }
+    gLinePatternTableReady = 1;
+}
+
+/**
+ * @brief 分析单个点在单个方向上的棋型 (查表: 从线编码中取出中心点两侧的窗口)
  * @param board (只读) 棋盘状态
- * @param pos 评估的中心点 (必须是该 player 的棋子)
+ * @param pos 评估的中心点 (假定该点已被 player 占据; 该点本身不参与查表)
+ * @param direction 方向编号 (gDirectionRow / gDirectionCol 的下标)
  * @param player 评估的玩家
+ * @return 识别到的棋型 (PatternType)
+ */
+int analyzeLine(const ChessBoard *board, const Coord pos, const int direction, const int player) {
+    int line, index;
+    lineLocate(direction, pos.row, pos.col, &line, &index);
+    // 窗口为线上 [index - LINE_WINDOW, index + LINE_WINDOW] 的格, 去掉中心一格
+    const ULL window = board->lineCodes[line] >> 2 * index;
+    const int code = (int) (window & ((1 << 2 * LINE_WINDOW) - 1)) | (int) (window >> 2 & (((1 << 2 * LINE_WINDOW) - 1) << 2 * LINE_WINDOW));
+    return gLinePatternTable[code] >> (player == PIECE_W ? 4 : 0) & 0xF;
+}
+
+/**
+ * @brief 加载棋型得分 (初始化 gPatternScores)
+ */
+void loadPatternScores() {
+    // 步骤 1: 确保全局表在初始化前是干净的 (棋型查找表只需生成一次)
+    clearPatternTable(&gPatternScores);
+    if (!gLinePatternTableReady) {
+        buildLinePatternTable();
+    }
+
+    // 步骤 2: 初始化 AI (我方) 的棋型得分 (使用宏定义的分数)
+    gPatternScores.AIFitting[PATTERN_FIVE] = SCORE_FIVE;
+    gPatternScores.AIFitting[PATTERN_FOUR_OPEN] = SCORE_FOUR_OPEN;
+    gPatternScores.AIFitting[PATTERN_THREE_OPEN] = SCORE_THREE_OPEN;
+    gPatternScores.AIFitting[PATTERN_FOUR_RUSH] = SCORE_FOUR_RUSH;
+    gPatternScores.AIFitting[PATTERN_JUMP_FOUR_OPEN] = SCORE_JUMP_FOUR_OPEN;
+    gPatternScores.AIFitting[PATTERN_JUMP_THREE_OPEN] = SCORE_JUMP_THREE_OPEN;
+    gPatternScores.AIFitting[PATTERN_JUMP_FOUR_SLEEP] = SCORE_JUMP_FOUR_SLEEP;
+    gPatternScores.AIFitting[PATTERN_TWO_OPEN] = SCORE_TWO_OPEN;
+    gPatternScores.AIFitting[PATTERN_THREE_SLEEP] = SCORE_THREE_SLEEP;
+    gPatternScores.AIFitting[PATTERN_TWO_SLEEP] = SCORE_TWO_SLEEP;
+    gPatternScores.AIFitting[PATTERN_INVALID] = SCORE_INVALID;
+
+    // 步骤 3: 动态计算对手的棋型分数
+    for (int i = 0; i < PATTERN_COUNT; i++) {
+        // 计算对手的棋型分数 (将 AI 的分数乘以一个权重)
+        gPatternScores.OppFitting[i] = gPatternScores.AIFitting[i] * PATTERN_WEIGHT;
+    }
+}
+
+/**
+ * @brief 由一个棋子在 4 个方向上的棋型计算它的威胁分 (getPlayerThreat 与增量评估共用)
+ * @param patterns 4 个方向的棋型 (PatternType)
  * @return 该点的总威胁分数
  */
-LL getPlayerThreat(const ChessBoard *board, const Coord pos, const int player) {
+LL getPatternThreat(const unsigned char patterns[4]) {
     LL totalScore = 0;
 
-    // 步骤 1: 遍历 4 个基本方向
+    // 步骤 1: 累加各方向棋型的分数
     for (int i = 0; i < 4; i++) {
-        // 步骤 2: 分析该点在该方向上的棋型
-        const int patternType = analyzeLine(board, pos, gDirectionRow[i], gDirectionCol[i], player);
-        // 步骤 3: 累加该棋型的分数
-        totalScore += gPatternScores.AIFitting[patternType];
+        totalScore += gPatternScores.AIFitting[patterns[i]];
     }
 
-    // 步骤 4: "双三" 或 "三四" 组合的特殊加分
+    // 步骤 2: "双三" 或 "三四" 组合的特殊加分
     // 这是一个关键的启发式规则!
     // 1100(活三) + 900(跳活三) = 2000 >= 1500
     // 1000(冲四) + 1100(活三) = 2100 >= 1500
@@ -559,10 +1552,30 @@ LL getPlayerThreat(const ChessBoard *board, const Coord pos, const int player) {
         totalScore = 1000000LL;
     }
 
-    // 步骤 5: 返回总分
+    // 步骤 3: 返回总分
     return totalScore;
 }
 
+/**
+ * @brief 评估单个玩家在某个点上的威胁 (计算该点在4个方向上的棋型总分)
+ * (此函数用于 evaluateBoardScore, 评估 *已存在* 的棋子)
+ * @param board (只读) 棋盘状态
+ * @param pos 评估的中心点 (必须是该 player 的棋子)
+ * @param player 评估的玩家
+ * @return 该点的总威胁分数
+ */
+LL getPlayerThreat(const ChessBoard *board, const Coord pos, const int player) {
+    unsigned char patterns[4];
+
+    // 步骤 1: 遍历 4 个基本方向, 分析该点在该方向上的棋型
+    for (int i = 0; i < 4; i++) {
+        patterns[i] = (unsigned char) analyzeLine(board, pos, i, player);
+    }
+
+    // 步骤 2: 由 4 个方向的棋型计算总分
+    return getPatternThreat(patterns);
+}
+
 /**
  * @brief 启发式评估：计算在某个点落子后的即时分数 (用于着法排序)
  * (此函数用于 generateCandidates, 评估空点)
@@ -577,9 +1590,9 @@ LL getPositionHeuristic(const ChessBoard *board, const Coord pos) {
     // 步骤 1: 遍历 4 个基本方向
     for (int i = 0; i < 4; i++) {
         // 步骤 2: *假装* AI 在 pos 点落子, 并评估形成的棋型
-        const int aiPattern = analyzeLine(board, pos, gDirectionRow[i], gDirectionCol[i], gAiPlayerId);
+        const int aiPattern = analyzeLine(board, pos, i, gAiPlayerId);
         // 步骤 3: *假装* 对手 在 pos 点落子, 并评估形成的棋型
-        const int oppPattern = analyzeLine(board, pos, gDirectionRow[i], gDirectionCol[i], gOppPlayerId);
+        const int oppPattern = analyzeLine(board, pos, i, gOppPlayerId);
 
         // 步骤 4: 累加 AI 在此落子的分数
         aiScore += gPatternScores.AIFitting[aiPattern];
@@ -602,34 +1615,107 @@ LL getPositionHeuristic(const ChessBoard *board, const Coord pos) {
 }
 
 /**
- * @brief 评估整个棋盘的静态分数 (用于 Alpha-Beta 搜索的叶节点)
- * @param board (只读) 棋盘状态
- * @return 棋盘总分 (我方总分 - 各种总分)
+ * @brief 查表得到一个棋子在 4 个方向上的棋型
  */
-LL evaluateBoardScore(const ChessBoard *board) {
-    LL aiTotal = 0; // AI 在全盘的总威胁分
-    LL oppTotal = 0; // 对手在全盘的总威胁分
-
-    // 步骤 1: 遍历棋盘所有行
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        // 步骤 2: 遍历棋盘所有列
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            const Coord p = {i, j, 0}; // 创建坐标
+static void stonePatterns(const ChessBoard *board, const int row, const int col, const int player, unsigned char patterns[4]) {
+    const Coord pos = {row, col, 0};
+    for (int d = 0; d < 4; d++) {
+        patterns[d] = (unsigned char) analyzeLine(board, pos, d, player);
+    }
+}
 
-            // 步骤 3: 如果是 AI 的棋子
-            if (board->layout[i][j] == gAiPlayerId) {
-                // 步骤 4: 计算这个 AI 棋子产生的威胁分
-                aiTotal += getPlayerThreat(board, p, gAiPlayerId);
-                // 步骤 5: 如果是对手的棋子
-            } else if (board->layout[i][j] == gOppPlayerId) {
-                // 步骤 6: 计算这个对手棋子产生的威胁分
-                oppTotal += getPlayerThreat(board, p, gOppPlayerId);
+/**
+ * @brief 改写 (row, col) 的棋子 (经 boardProbeCell), 并增量更新评估 (由 boardUpdate 调用)
+ * 棋子在某方向上的棋型只取决于该方向的直线, 所以只有经过 (row, col) 的 4 条线上的棋子可能改变;
+ * 且 analyzeLine 从棋子出发只读到 "己方连子 + 至多一个空档 + 己方连子 + 下一格",
+ * 沿线向外扫描时, 中间出现两个空点或两种颜色的棋子之后, 更远的棋子就读不到 (row, col) 了.
+ * 棋型不保存在棋盘中: 改写前后各查一次这些棋子在所在方向上的棋型, 只有棋型变化的棋子才查齐另外 3 个方向, 更新威胁分
+ * (另外 3 个方向的线不经过 (row, col), 改写前后相同)
+ * @param board 指向棋盘
+ * @param row 行
+ * @param col 列
+ * @param piece 新棋子 (EMPTY_SLOT, PIECE_B, PIECE_W)
+ */
+void boardUpdateEvaluation(ChessBoard *board, const int row, const int col, const int piece) {
+    // 受影响的棋子 (每条线两侧各至多 MAX_BOARD_SIZE 个; 扫描不经过 (row, col) 本身, 改写前后找到的棋子相同)
+    struct {
+        int row, col, direction, piece, pattern;
+    } stones[4 * 2 * MAX_BOARD_SIZE];
+    int count = 0;
+
+    // 步骤 1: 找出 4 条线上读得到 (row, col) 的棋子, 记下它们在所在方向上改写前的棋型
+    for (int d = 0; d < 4; d++) {
+        for (int sign = -1; sign <= 1; sign += 2) {
+            const int dRow = sign * gDirectionRow[d];
+            const int dCol = sign * gDirectionCol[d];
+            const int step = sign * gDirectionStride[d];
+            int empties = 0;
+            int color = EMPTY_SLOT; // 中间已经经过的棋子的颜色
+            // 走到哨兵格为止 (不需要边界检查)
+            for (int k = CELL_INDEX(row, col) + step, r = row + dRow, c = col + dCol; board->cells[k] != CELL_WALL; k += step, r += dRow, c += dCol) {
+                const int stone = board->cells[k];
+                if (stone == EMPTY_SLOT) {
+                    if (++empties >= 2) {
+                        break;
+                    }
+                    continue;
+                }
+                if (color != EMPTY_SLOT && color != stone) {
+                    break;
+                }
+                color = stone;
+                stones[count].row = r;
+                stones[count].col = c;
+                stones[count].direction = d;
+                stones[count].piece = stone;
+                const Coord pos = {r, c, 0};
+                stones[count].pattern = analyzeLine(board, pos, d, stone);
+                count++;
             }
         }
     }
 
-    // 步骤 7: 最终静态分数 = AI总威胁 - 对手总威胁
-    return aiTotal - oppTotal;
+    // 步骤 2: 移除旧棋子的威胁分, 改写棋盘
+    const int oldPiece = board->cells[CELL_INDEX(row, col)];
+    if (oldPiece != EMPTY_SLOT) {
+        unsigned char patterns[4];
+        stonePatterns(board, row, col, oldPiece, patterns);
+        board->threatTotals[oldPiece] -= getPatternThreat(patterns);
+    }
+    boardProbeCell(board, row, col, piece);
+
+    // 步骤 3: 受影响的棋子只有所在方向的棋型可能改变; 改变时按新旧 4 个棋型计算威胁分之差
+    for (int n = 0; n < count; n++) {
+        const Coord pos = {stones[n].row, stones[n].col, 0};
+        const int d = stones[n].direction;
+        const int pattern = analyzeLine(board, pos, d, stones[n].piece);
+        if (pattern == stones[n].pattern) {
+            continue;
+        }
+        unsigned char patterns[4];
+        stonePatterns(board, pos.row, pos.col, stones[n].piece, patterns);
+        LL delta = getPatternThreat(patterns);
+        patterns[d] = (unsigned char) stones[n].pattern;
+        delta -= getPatternThreat(patterns);
+        board->threatTotals[stones[n].piece] += delta;
+    }
+
+    // 步骤 4: 新棋子: 分析 4 个方向的棋型并计入总分
+    if (piece != EMPTY_SLOT) {
+        unsigned char patterns[4];
+        stonePatterns(board, row, col, piece, patterns);
+        board->threatTotals[piece] += getPatternThreat(patterns);
+    }
+}
+
+/**
+ * @brief 评估整个棋盘的静态分数 (用于 Alpha-Beta 搜索的叶节点)
+ * 各棋子的威胁分 (getPlayerThreat) 由 boardUpdate 增量维护, 这里只需相减, O(1)
+ * @param board (只读) 棋盘状态
+ * @return 棋盘总分 (AI 全盘总威胁 - 对手全盘总威胁)
+ */
+LL evaluateBoardScore(const ChessBoard *board) {
+    return board->threatTotals[gAiPlayerId] - board->threatTotals[gOppPlayerId];
 }
 
 // --- 候选着法生成 --- //
@@ -650,67 +1736,160 @@ int isNearPiece(const ChessBoard *board, const int r, const int c) {
         return r >= centerMin && r <= centerMax && c >= centerMin && c <= centerMax;
     }
 
-    // 步骤 1: 遍历 8 个方向
-    for (int d = 0; d < 8; d++) {
-        // 步骤 2: 检查 1 到 2 格的距离
-        for (int dist = 1; dist <= 2; dist++) {
-            // 步骤 3: 定义 8 个方向的 (dx, dy)
-            const int directions[8][2] = {
-                {-1, 0}, {1, 0}, {0, -1}, {0, 1}, // 上下左右
-                {-1, -1}, {-1, 1}, {1, -1}, {1, 1} // 4个斜向
-            };
-            // 步骤 4: 计算目标坐标
-            const int newRow = r + directions[d][0] * dist;
-            const int newCol = c + directions[d][1] * dist;
-
-            // 步骤 5: 检查坐标是否在棋盘内
-            if (newRow >= 0 && newRow < BOARD_SIZE && newCol >= 0 && newCol < BOARD_SIZE) {
-                // 步骤 6: 检查该点是否有棋子 (非空)
-                if (board->layout[newRow][newCol] != EMPTY_SLOT) {
-                    return 1; // 附近有子, 返回 1 (true)
-                }
-            }
+    // 步骤 1: 遍历 4 条线 (8 个方向), 取线编码中距离中心 1 到 2 的 4 格
+    const ULL nearMask = (0x5ULL << 2 * (LINE_WINDOW - 2)) | (0x5ULL << 2 * (LINE_WINDOW + 1));
+    for (int d = 0; d < 4; d++) {
+        // 步骤 2: 其中有棋子 (界外不算) 即附近有子
+        if (lineOccupiedBits(lineWindow(board, d, r, c)) & nearMask) {
+            return 1;
         }
     }
-    // 步骤 7: 遍历完所有方向和距离, 附近无子
+    // 步骤 3: 遍历完所有方向和距离, 附近无子
     return 0;
 }
 
 /**
- * @brief 生成候选着法列表，并按启发式分数排序
+ * @brief 着法排序加分: 杀手着法与历史表 (搜索过程中学到的 "哪些着法引发过剪枝")
+ * @param worker 搜索线程 (杀手着法与历史表按线程保存)
+ * @param ply 当前层数 (根节点为 0)
+ * @param player 落子方
+ * @param row 行
+ * @param col 列
+ * @return 排序加分 (叠加在启发式分数之上)
+ */
+LL getOrderingBonus(const SearchWorker *worker, const int ply, const int player, const int row, const int col) {
+    LL bonus = 0;
+
+    // 步骤 1: 杀手着法 (同一层的兄弟节点中引发过剪枝)
+    if (ply < MAX_PLY) {
+        if (worker->ordering.killerMoves[ply][0].row == row && worker->ordering.killerMoves[ply][0].col == col) {
+            bonus += KILLER_BONUS_PRIMARY;
+        } else if (worker->ordering.killerMoves[ply][1].row == row && worker->ordering.killerMoves[ply][1].col == col) {
+            bonus += KILLER_BONUS_SECONDARY;
+        }
+    }
+
+    // 步骤 2: 历史分数 (整盘搜索中该方在此处引发剪枝的累计次数, 按深度加权)
+    const LL history = worker->ordering.historyScores[player][row][col] >> HISTORY_BONUS_SHIFT;
+    bonus += history < HISTORY_BONUS_MAX ? history : HISTORY_BONUS_MAX;
+
+    return bonus;
+}
+
+/**
+ * @brief 记录引发剪枝的着法 (更新杀手着法与历史表)
+ * @param worker 搜索线程
+ * @param ply 当前层数
+ * @param player 落子方
+ * @param move 引发剪枝的着法
+ * @param depth 该节点的剩余深度 (越深的剪枝越有价值)
+ */
+void recordCutoffMove(SearchWorker *worker, const int ply, const int player, const Coord move, const int depth) {
+    // 步骤 1: 更新杀手着法 (新杀手放在第一位, 旧的第一杀手降为第二)
+    if (ply < MAX_PLY && (worker->ordering.killerMoves[ply][0].row != move.row || worker->ordering.killerMoves[ply][0].col != move.col)) {
+        worker->ordering.killerMoves[ply][1] = worker->ordering.killerMoves[ply][0];
+        worker->ordering.killerMoves[ply][0] = move;
+    }
+    // 步骤 2: 历史分数按 depth^2 累加
+    worker->ordering.historyScores[player][move.row][move.col] += (LL) depth * depth;
+}
+
+/**
+ * @brief 为新的一步决策重置排序启发: 清空杀手着法, 历史分数减半 (老化)
+ * @param worker 搜索线程
+ */
+void resetOrderingHeuristics(SearchWorker *worker) {
+    for (int ply = 0; ply < MAX_PLY; ply++) {
+        for (int slot = 0; slot < 2; slot++) {
+            worker->ordering.killerMoves[ply][slot].row = MOVE_NONE;
+            worker->ordering.killerMoves[ply][slot].col = MOVE_NONE;
+            worker->ordering.killerMoves[ply][slot].score = 0;
+        }
+    }
+    for (int p = 0; p < 3; p++) {
+        for (int i = 0; i < MAX_BOARD_SIZE; i++) {
+            for (int j = 0; j < MAX_BOARD_SIZE; j++) {
+                worker->ordering.historyScores[p][i][j] >>= 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 去除对称局面中互相等价的候选着法 (每组等价着法只保留排在最前的一个)
+ * 局面在变换 s 下不变时, 着法 m 与 s(m) 的搜索结果相同, 只需搜索其中一个
+ * @param board (只读) 棋盘状态
+ * @param list (出入参) 已排序的候选着法列表
+ */
+void removeSymmetricCandidates(const ChessBoard *board, CandidateList *list) {
+    const int mask = boardSymmetryMask(board);
+    if (mask == 1) {
+        return;
+    }
+    int kept = 0;
+    for (int i = 0; i < list->count; i++) {
+        const Coord move = list->candidates[i];
+        int duplicate = 0;
+        for (int s = 1; s < SYMMETRY_COUNT && !duplicate; s++) {
+            if (!(mask & 1 << s)) {
+                continue;
+            }
+            int r = move.row;
+            int c = move.col;
+            symmetryApply(s, &r, &c, 0);
+            for (int k = 0; k < kept && !duplicate; k++) {
+                duplicate = list->candidates[k].row == r && list->candidates[k].col == c;
+            }
+        }
+        if (!duplicate) {
+            list->candidates[kept++] = move;
+        }
+    }
+    list->count = kept;
+}
+
+void scanCandidateCells(const ChessBoard *board, unsigned int *rowMasks);
+
+/**
+ * @brief 生成候选着法列表，并按启发式分数排序 (保留的着法再叠加杀手着法与历史表加分)
+ * @param worker 搜索线程 (提供杀手着法与历史表)
  * @param board (只读) 棋盘状态
  * @param list (出参) 指向 CandidateList 的指针，用于填充
+ * @param ply 当前层数 (根节点为 0)
+ * @param player 落子方
  */
-void generateCandidates(const ChessBoard *board, CandidateList *list) {
+void generateCandidates(const SearchWorker *worker, const ChessBoard *board, CandidateList *list, const int ply, const int player) {
     // 步骤 1: 初始化列表
     list->count = 0;
     LL hScore = 0; // 临时存储启发分
     int firstZero = 1; // 标记是否已添加了第一个 0 分着法 (作为备选)
 
-    // 步骤 2: 遍历棋盘所有行
+    // 步骤 2: 全盘扫描 "好" 的候选点, 每行一个位掩码
+    // 规则: 1. 必须是空点 2. 必须在现有棋子 2 格范围内
+    unsigned int rowMasks[MAX_BOARD_SIZE];
+    scanCandidateCells(board, rowMasks);
+
+    // 步骤 3: 遍历棋盘所有行
     for (int i = 0; i < BOARD_SIZE; i++) {
-        // 步骤 3: 遍历棋盘所有列
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            // 步骤 4: 检查是否为 "好" 的候选点
-            // 规则: 1. 必须是空点 2. 必须在现有棋子 2 格范围内
-            if (board->layout[i][j] == EMPTY_SLOT && isNearPiece(board, i, j)) {
-                // 步骤 5: 计算该点的启发式分数 (进攻分 + 防守分)
-                const Coord tempPos = {i, j, 0};
-                hScore = getPositionHeuristic(board, tempPos);
-
-                // 步骤 6: 只添加一个 0 分着法 (保证有棋可走)
-                if (hScore == 0 && firstZero) {
-                    list->candidates[list->count] = tempPos;
-                    list->candidates[list->count].score = hScore;
-                    list->count++;
-                    firstZero = 0; // 不再添加 0 分着法
-
-                    // 步骤 7: 添加所有 > 0 分的着法
-                } else if (hScore > 0) {
-                    list->candidates[list->count] = tempPos;
-                    list->candidates[list->count].score = hScore;
-                    list->count++;
-                }
+        // 步骤 4: 按列顺序遍历该行的候选点
+        for (unsigned int bits = rowMasks[i]; bits; bits &= bits - 1) {
+            const int j = __builtin_ctz(bits);
+            // 步骤 5: 计算该点的启发式分数 (进攻分 + 防守分)
+            const Coord tempPos = {i, j, 0};
+            hScore = getPositionHeuristic(board, tempPos);
+
+            // 步骤 6: 只添加一个 0 分着法 (保证有棋可走)
+            if (hScore == 0 && firstZero) {
+                list->candidates[list->count] = tempPos;
+                list->candidates[list->count].score = hScore;
+                list->count++;
+                firstZero = 0; // 不再添加 0 分着法
+
+                // 步骤 7: 添加所有 > 0 分的着法
+            } else if (hScore > 0) {
+                list->candidates[list->count] = tempPos;
+                list->candidates[list->count].score = hScore;
+                list->count++;
             }
         }
     }
@@ -722,170 +1901,2460 @@ void generateCandidates(const ChessBoard *board, CandidateList *list) {
         sortCandidatesByScore(list);
     }
 
-    // 步骤 9: 候选着法剪枝 (Beam Search)
-    // 限制搜索宽度, 只考虑最好的 N 个着法
-    // 这里限制为 6, 大幅减少搜索空间, 提高速度
-    list->count = list->count > 6 ? 6 : list->count;
+    // 步骤 8a: 根节点去除对称等价的着法 (开局的对称局面最多减少到 1/8; 在截断宽度之前去除, 保留的都是不同的着法)
+    if (ply == 0) {
+        removeSymmetricCandidates(board, list);
+    }
+
+    // 步骤 9: 限制搜索宽度, 只考虑最好的 N 个着法 (gLmrConfig.maxCandidates)
+    // 靠后的安静着法由 alphaBeta 的后期着法缩减 (LMR) 以较浅深度搜索, 而不是直接丢弃
+    if (gLmrConfig.maxCandidates > 0 && list->count > gLmrConfig.maxCandidates) {
+        list->count = gLmrConfig.maxCandidates;
+    }
+
+    // 步骤 10: 在保留的着法中叠加杀手着法与历史表加分, 重新排序
+    // (只影响搜索顺序, 不改变被保留的着法集合)
+    for (int k = 0; k < list->count; k++) {
+        list->candidates[k].score += getOrderingBonus(worker, ply, player, list->candidates[k].row, list->candidates[k].col);
+    }
+    if (list->count > 1) {
+        sortCandidatesByScore(list);
+    }
 }
 
-// --- Alpha-Beta 搜索 --- //
+// --- 全盘扫描内核 --- //
 
 /**
- * @brief Alpha-Beta 剪枝搜索 (核心)
- * @param board (可写) 棋盘状态 (函数会进行落子和悔棋)
- * @param depth 剩余搜索深度
- * @param alpha Alpha 值 (我方能保证的最低分)
- * @param beta Beta 值 (对手能保证的最高分)
- * @param player 当前轮到谁 (AI 或 Opponent)
- * @param lastMove 上一步的落子 (用于胜负判断)
- * @return 当前局面的评估分数
+ * @brief 检查 player 在 (row, col) 落子后是否形成连五 (不要求该点当前为空)
+ * @param board (只读) 棋盘状态
+ * @param row 行
+ * @param col 列
+ * @param player 玩家
+ * @return 1 (形成连五) 或 0
  */
-LL alphaBeta(ChessBoard *board, const int depth, LL alpha, LL beta, const int player, const Coord lastMove) {
-    // --- 步骤 1: 置换表查找 ---
-    // 在搜索开始时, 立即查询置换表
-    const LL hashVal = ttSearch(board->currentHash, depth, alpha, beta);
-    if (hashVal > SCORE_MIN - 1LL) {
-        // 如果命中 (分数有效), 直接返回存储的分数, 剪掉整个子树
-        return hashVal;
+int makesFive(const ChessBoard *board, const int row, const int col, const int player) {
+    for (int d = 0; d < 4; d++) {
+        // 窗口中心 (第 LINE_WINDOW 格) 视为 player 的棋子; run 的第 k 格为 1 表示第 k 到 k + 4 格都是 player 的棋子
+        const ULL stones = lineStoneBits(lineWindow(board, d, row, col), player) | 1ULL << 2 * LINE_WINDOW;
+        const ULL run = stones & stones >> 2 & stones >> 4 & stones >> 6 & stones >> 8;
+        // 经过中心的连五从第 LINE_WINDOW - 4 到第 LINE_WINDOW 格开始
+        if (run & 0x155ULL << 2 * (LINE_WINDOW - 4)) {
+            return 1;
+        }
     }
+    return 0;
+}
 
-    // --- 步骤 2: 胜负判断 (基于上一步) ---
-    // (这是 "达到叶节点" 的一种情况: 游戏已结束)
-    // 检查 *上一步* 的落子 (lastMove) 是否导致了胜利
-
-    // 2a: 如果当前是 AI 走, 检查 对手 的上一步 (lastMove) 是否获胜
+/**
+ * @brief 全盘扫描 (标量内核): 每行一个位掩码, 第 j 位为 1 表示 (row, j) 是空点且附近有子 (即 isNearPiece)
+ */
+static void scanCandidateCellsScalar(const ChessBoard *board, unsigned int *rowMasks) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        rowMasks[i] = 0;
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (board->cells[CELL_INDEX(i, j)] == EMPTY_SLOT && isNearPiece(board, i, j)) {
+                rowMasks[i] |= 1u << j;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 全盘扫描 (标量内核): 每行一个位掩码, 第 j 位为 1 表示 (row, j) 是 player 的成五点 (空点且 makesFive)
+ */
+static void scanFivePointsScalar(const ChessBoard *board, const int player, unsigned int *rowMasks) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        rowMasks[i] = 0;
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (board->cells[CELL_INDEX(i, j)] == EMPTY_SLOT && makesFive(board, i, j, player)) {
+                rowMasks[i] |= 1u << j;
+            }
+        }
+    }
+}
+
+#ifdef GOMOKU_X86_SIMD
+// 向量内核: 每次比较一行中 16 格的字节; 一维棋盘的哨兵边框保证偏移 ±4 行 ±4 列的读取不越界,
+// 读到行尾之外 (哨兵列与下一行) 的位最后由 BOARD_SIZE 的掩码去掉.
+// (原生棋盘固定为 12 路, 一次 16 字节的比较已覆盖一行, 更宽的 AVX2 没有可用之处)
+
+// 邻近判断的 16 个偏移: 8 个方向上距离 1 与 2 的格 (同 isNearPiece)
+static const int gNearOffsets[16] = {
+    -BOARD_STRIDE, BOARD_STRIDE, -1, 1, -BOARD_STRIDE - 1, -BOARD_STRIDE + 1, BOARD_STRIDE - 1, BOARD_STRIDE + 1,
+    -2 * BOARD_STRIDE, 2 * BOARD_STRIDE, -2, 2, -2 * BOARD_STRIDE - 2, -2 * BOARD_STRIDE + 2, 2 * BOARD_STRIDE - 2, 2 * BOARD_STRIDE + 2
+};
+
+static void scanCandidateCellsSse2(const ChessBoard *board, unsigned int *rowMasks) {
+    const __m128i black = _mm_set1_epi8(PIECE_B);
+    const __m128i white = _mm_set1_epi8(PIECE_W);
+    const __m128i empty = _mm_setzero_si128();
+    const unsigned int rowBits = (1u << BOARD_SIZE) - 1;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        unsigned int mask = 0;
+        for (int chunk = 0; chunk < BOARD_SIZE; chunk += 16) {
+            const unsigned char *base = &board->cells[CELL_INDEX(i, chunk)];
+            __m128i near = _mm_setzero_si128();
+            for (int k = 0; k < 16; k++) {
+                const __m128i v = _mm_loadu_si128((const __m128i *) (base + gNearOffsets[k]));
+                near = _mm_or_si128(near, _mm_or_si128(_mm_cmpeq_epi8(v, black), _mm_cmpeq_epi8(v, white)));
+            }
+            const __m128i here = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) base), empty);
+            mask |= (unsigned int) _mm_movemask_epi8(_mm_and_si128(near, here)) << chunk;
+        }
+        rowMasks[i] = mask & rowBits;
+    }
+}
+
+// 一个方向上的成五判断: 中心两侧 player 的连续棋子数之和不小于 4 (left[k] / right[k] 表示该侧至少连续 k + 1 子)
+static inline __m128i fiveLineSse2(const unsigned char *base, const int step, const __m128i stone) {
+    __m128i left[4], right[4];
+    for (int k = 0; k < 4; k++) {
+        left[k] = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (base - (k + 1) * step)), stone);
+        right[k] = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (base + (k + 1) * step)), stone);
+        if (k > 0) {
+            left[k] = _mm_and_si128(left[k], left[k - 1]);
+            right[k] = _mm_and_si128(right[k], right[k - 1]);
+        }
+    }
+    __m128i five = _mm_or_si128(left[3], right[3]);
+    for (int k = 0; k < 3; k++) {
+        five = _mm_or_si128(five, _mm_and_si128(left[k], right[2 - k]));
+    }
+    return five;
+}
+
+static void scanFivePointsSse2(const ChessBoard *board, const int player, unsigned int *rowMasks) {
+    const __m128i stone = _mm_set1_epi8((char) player);
+    const __m128i empty = _mm_setzero_si128();
+    const unsigned int rowBits = (1u << BOARD_SIZE) - 1;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        unsigned int mask = 0;
+        for (int chunk = 0; chunk < BOARD_SIZE; chunk += 16) {
+            const unsigned char *base = &board->cells[CELL_INDEX(i, chunk)];
+            __m128i five = fiveLineSse2(base, BOARD_STRIDE, stone);
+            five = _mm_or_si128(five, fiveLineSse2(base, 1, stone));
+            five = _mm_or_si128(five, fiveLineSse2(base, BOARD_STRIDE + 1, stone));
+            five = _mm_or_si128(five, fiveLineSse2(base, BOARD_STRIDE - 1, stone));
+            const __m128i here = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) base), empty);
+            mask |= (unsigned int) _mm_movemask_epi8(_mm_and_si128(five, here)) << chunk;
+        }
+        rowMasks[i] = mask & rowBits;
+    }
+}
+#endif
+
+/**
+ * @brief 选择全盘扫描内核 (SCAN_KERNEL_AUTO 表示按 CPUID 选择最快的可用内核)
+ * @param kernel SCAN_KERNEL_*
+ * @return 1 (已切换) 或 0 (本机或本构建不支持, 保持原内核)
+ */
+int scanSelectKernel(int kernel) {
+#ifdef GOMOKU_X86_SIMD
+    __builtin_cpu_init();
+    const int hasSse2 = __builtin_cpu_supports("sse2");
+#else
+    const int hasSse2 = 0;
+#endif
+    if (kernel == SCAN_KERNEL_AUTO) {
+        kernel = hasSse2 ? SCAN_KERNEL_SSE2 : SCAN_KERNEL_SCALAR;
+    }
+    if ((kernel == SCAN_KERNEL_SSE2 && !hasSse2) || kernel < SCAN_KERNEL_SCALAR || kernel > SCAN_KERNEL_SSE2) {
+        return 0;
+    }
+    gScanKernel = kernel;
+    return 1;
+}
+
+/**
+ * @brief 全盘扫描: 空点且附近有子的格 (候选着法生成的第一步; 空棋盘时为中心区域, 同 isNearPiece)
+ * @param board (只读) 棋盘状态
+ * @param rowMasks (出参) BOARD_SIZE 个行掩码
+ */
+void scanCandidateCells(const ChessBoard *board, unsigned int *rowMasks) {
+#ifdef GOMOKU_X86_SIMD
+    // 空棋盘的中心区域规则只在 isNearPiece 中, 走标量内核
+    if (board->currentHash == 0) {
+        scanCandidateCellsScalar(board, rowMasks);
+        return;
+    }
+    if (gScanKernel == SCAN_KERNEL_SSE2) {
+        scanCandidateCellsSse2(board, rowMasks);
+        return;
+    }
+#endif
+    scanCandidateCellsScalar(board, rowMasks);
+}
+
+/**
+ * @brief 全盘扫描: player 的成五点
+ * @param board (只读) 棋盘状态
+ * @param player 玩家
+ * @param rowMasks (出参) BOARD_SIZE 个行掩码
+ */
+void scanFivePoints(const ChessBoard *board, const int player, unsigned int *rowMasks) {
+#ifdef GOMOKU_X86_SIMD
+    if (gScanKernel == SCAN_KERNEL_SSE2) {
+        scanFivePointsSse2(board, player, rowMasks);
+        return;
+    }
+#endif
+    scanFivePointsScalar(board, player, rowMasks);
+}
+
+// --- 连续冲四 (VCF) 求解 --- //
+
+/**
+ * @brief 不需要搜索的着法: 我方一步成五, 或对手只有一个成五点 (必须堵住)
+ * @param board (只读) 棋盘状态
+ * @param move (出参) 找到时的着法
+ * @return 1 (找到) 或 0 (需要正常搜索; 包括对手有两个以上成五点的必败局面)
+ */
+int findForcedMove(const ChessBoard *board, Coord *move) {
+    unsigned int rowMasks[MAX_BOARD_SIZE];
+    // 我方成五: 直接获胜 (取行、列顺序的第一个)
+    scanFivePoints(board, gAiPlayerId, rowMasks);
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        if (rowMasks[i]) {
+            move->row = i;
+            move->col = __builtin_ctz(rowMasks[i]);
+            move->score = SCORE_FIVE;
+            return 1;
+        }
+    }
+    // 对手恰好一个成五点: 必须堵住
+    scanFivePoints(board, gOppPlayerId, rowMasks);
+    int blockCount = 0;
+    Coord block = {-1, -1, 0};
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        if (rowMasks[i]) {
+            blockCount += __builtin_popcount(rowMasks[i]);
+            block.row = i;
+            block.col = __builtin_ctz(rowMasks[i]);
+        }
+    }
+    if (blockCount == 1) {
+        *move = block;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 收集经过 (row, col) 的 4 条线上 (距离 4 以内) player 的成五点
+ * (只有刚落下的棋子附近会产生新的成五点, 不必扫描全盘)
+ * @param board (只读) 棋盘状态
+ * @param row 行
+ * @param col 列
+ * @param player 玩家
+ * @param out (出参) 成五点, 最多写入 maxOut 个
+ * @param maxOut out 的容量
+ * @return 成五点总数 (可能大于 maxOut)
+ */
+int collectFivePointsAround(const ChessBoard *board, const int row, const int col, const int player, Coord *out, const int maxOut) {
+    int count = 0;
+    for (int d = 0; d < 4; d++) {
+        for (int dist = -4; dist <= 4; dist++) {
+            const int r = row + dist * gDirectionRow[d];
+            const int c = col + dist * gDirectionCol[d];
+            // 距离 4 以内不会越出哨兵边框, 棋盘外的格是 CELL_WALL, 自然跳过
+            if (dist == 0 || board->cells[CELL_INDEX(r, c)] != EMPTY_SLOT) {
+                continue;
+            }
+            if (makesFive(board, r, c, player)) {
+                if (count < maxOut) {
+                    out[count].row = r;
+                    out[count].col = c;
+                    out[count].score = 0;
+                }
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 扫描全盘, 收集 player 的成五点
+ * @param board (只读) 棋盘状态
+ * @param player 玩家
+ * @param out (出参) 成五点, 最多写入 maxOut 个
+ * @param maxOut out 的容量 (找到 maxOut 个后即停止)
+ * @return 找到的成五点数 (不超过 maxOut)
+ */
+int collectFivePoints(const ChessBoard *board, const int player, Coord *out, const int maxOut) {
+    unsigned int rowMasks[MAX_BOARD_SIZE];
+    scanFivePoints(board, player, rowMasks);
+    int count = 0;
+    for (int i = 0; i < BOARD_SIZE && count < maxOut; i++) {
+        for (unsigned int bits = rowMasks[i]; bits && count < maxOut; bits &= bits - 1) {
+            out[count].row = i;
+            out[count].col = __builtin_ctz(bits);
+            out[count].score = 0;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 快速预筛: 经过 (row, col) 的某个方向上 ±4 格内是否至少有 minStones 个 player 的棋子
+ * (冲四要求某个方向上 5 格窗口内有 4 子, 所以 minStones = 3 时不满足的点不可能是冲四点;
+ *  同理 minStones = 2 可以排除不可能形成活三的点)
+ * @return 1 (可能) 或 0 (不可能)
+ */
+int hasLineStones(const ChessBoard *board, const int row, const int col, const int player, const int minStones) {
+    // 窗口中距离中心 1 到 4 的 8 格
+    const ULL nearMask = (0x55ULL << 2 * (LINE_WINDOW - 4)) | (0x55ULL << 2 * (LINE_WINDOW + 1));
+    for (int d = 0; d < 4; d++) {
+        if (__builtin_popcountll(lineStoneBits(lineWindow(board, d, row, col), player) & nearMask) >= minStones) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief VCF 递归搜索 (攻方走棋)
+ * 攻方只走冲四, 守方只能挡唯一的成五点; 守方挡的同时若形成冲四, 攻方必须先挡, 且这一手也必须是冲四
+ * (不变式: 进入本函数时攻方没有成五点, 守方的成五点只可能出现在 forced 中)
+ * @param board (可写) 棋盘状态
+ * @param attacker 攻方
+ * @param depth 剩余的攻方步数
+ * @param forced 守方的唯一成五点 (攻方必须挡在这里), NULL 表示攻方可自由冲四
+ * @param line (出参) 获胜着法序列 (攻, 守, 攻, 守 ... 攻)
+ * @return 获胜序列长度 (> 0 表示找到 VCF), 0 表示未找到
+ */
+int vcfAttack(ChessBoard *board, const int attacker, const int depth, const Coord *forced, Coord *line) {
+    const int defender = 3 - attacker;
+
+    // 步骤 1: 节点预算与深度检查
+    if (++gVcfNodes > gVcfNodeLimit) {
+        gVcfAborted = 1;
+        return 0;
+    }
+    if (depth <= 0) {
+        return 0;
+    }
+
+    // 步骤 2: 查询失败缓存
+    const ULL key = board->currentHash ^ gVcfAttackerKeys[attacker];
+    VCF_Entry *entry = &gVcfCache[key % VCF_CACHE_SIZE];
+    if (entry->key == key && entry->depth >= depth) {
+        return 0;
+    }
+
+    // 步骤 3: 生成攻方着法 (被迫挡四时只有一个着法)
+    Coord moves[MAX_CANDIDATES];
+    int moveCount = 0;
+    if (forced != 0) {
+        moves[moveCount++] = *forced;
+    } else {
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                if (board->cells[CELL_INDEX(i, j)] == EMPTY_SLOT && hasLineStones(board, i, j, attacker, 3)) {
+                    moves[moveCount].row = i;
+                    moves[moveCount].col = j;
+                    moves[moveCount].score = 0;
+                    moveCount++;
+                }
+            }
+        }
+    }
+
+    // 步骤 4: 逐个尝试冲四
+    for (int k = 0; k < moveCount && !gVcfAborted; k++) {
+        const Coord move = moves[k];
+        boardUpdate(board, move.row, move.col, attacker);
+
+        Coord fives[2];
+        const int fiveCount = collectFivePointsAround(board, move.row, move.col, attacker, fives, 2);
+        if (fiveCount >= 2) {
+            // 4a: 活四或双四, 守方挡不住
+            boardUpdate(board, move.row, move.col, EMPTY_SLOT);
+            line[0] = move;
+            return 1;
+        }
+        if (fiveCount == 1) {
+            // 4b: 冲四, 守方只能挡唯一的成五点
+            const Coord block = fives[0];
+            boardUpdate(board, block.row, block.col, defender);
+
+            // 守方挡的同时形成的冲四: 两个以上成五点则攻方失败, 一个则攻方下一手必须挡
+            Coord counterFives[2];
+            const int counterCount = collectFivePointsAround(board, block.row, block.col, defender, counterFives, 2);
+            int length = 0;
+            if (counterCount < 2) {
+                length = vcfAttack(board, attacker, depth - 1, counterCount == 1 ? &counterFives[0] : 0, line + 2);
+            }
+
+            boardUpdate(board, block.row, block.col, EMPTY_SLOT);
+            if (length > 0) {
+                boardUpdate(board, move.row, move.col, EMPTY_SLOT);
+                line[0] = move;
+                line[1] = block;
+                return length + 2;
+            }
+        }
+        boardUpdate(board, move.row, move.col, EMPTY_SLOT);
+    }
+
+    // 步骤 5: 完整搜索后仍无解, 记入缓存 (因预算中止的结论不可靠, 不记录)
+    if (!gVcfAborted) {
+        entry->key = key;
+        entry->depth = depth;
+    }
+    return 0;
+}
+
+/**
+ * @brief VCF 求解入口: 判断 attacker 先走时能否通过连续冲四取胜
+ * @param board (可写) 棋盘状态 (求解结束后恢复原状)
+ * @param attacker 攻方 (即轮到走棋的一方)
+ * @param nodeLimit 节点上限
+ * @param line (出参) 获胜着法序列, 容量至少为 VCF_MAX_LINE
+ * @return 获胜序列长度 (> 0 表示找到 VCF), 0 表示未找到或超出预算
+ */
+int vcfSolve(ChessBoard *board, const int attacker, const ULL nodeLimit, Coord *line) {
+    gVcfNodes = 0;
+    gVcfNodeLimit = nodeLimit;
+    gVcfAborted = 0;
+
+    // 步骤 1: 攻方已有成五点, 直接获胜
+    if (collectFivePoints(board, attacker, line, 1) > 0) {
+        return 1;
+    }
+    // 步骤 2: 守方已有成五点: 两个以上则攻方挡不住, 一个则攻方第一手必须挡
+    Coord defenderFives[2];
+    const int defenderCount = collectFivePoints(board, 3 - attacker, defenderFives, 2);
+    if (defenderCount >= 2) {
+        return 0;
+    }
+    // 步骤 3: 递归搜索
+    return vcfAttack(board, attacker, VCF_MAX_DEPTH, defenderCount == 1 ? &defenderFives[0] : 0, line);
+}
+
+/**
+ * @brief 对手存在 VCF 时, 将根节点候选着法限制为能够化解它的防守着法
+ * 防守候选 = 原候选着法 + 对手获胜序列上的所有点; 逐个落子后重新求解对手的 VCF,
+ * 保留求解失败 (或超出预算无法证明) 的着法. 若没有着法能化解, 保持原列表不变 (已是败局)
+ * @param board (可写) 棋盘状态
+ * @param list (可写) 根节点候选着法
+ * @param oppLine 对手的获胜着法序列
+ * @param oppLineLength 序列长度
+ */
+void restrictToVcfDefences(ChessBoard *board, CandidateList *list, const Coord *oppLine, const int oppLineLength) {
+    // 步骤 1: 合并候选 (原候选 + 对手获胜序列上的空点)
+    CandidateList defences = *list;
+    for (int k = 0; k < oppLineLength; k++) {
+        int known = 0;
+        for (int i = 0; i < defences.count && !known; i++) {
+            known = defences.candidates[i].row == oppLine[k].row && defences.candidates[i].col == oppLine[k].col;
+        }
+        if (!known && defences.count < MAX_CANDIDATES) {
+            defences.candidates[defences.count] = oppLine[k];
+            defences.candidates[defences.count].score = getPositionHeuristic(board, oppLine[k]);
+            defences.count++;
+        }
+    }
+
+    // 步骤 2: 逐个检验: 落子后对手是否仍有 VCF
+    CandidateList survivors;
+    survivors.count = 0;
+    Coord line[VCF_MAX_LINE];
+    for (int i = 0; i < defences.count; i++) {
+        const Coord move = defences.candidates[i];
+        boardUpdate(board, move.row, move.col, gAiPlayerId);
+        const int stillWins = vcfSolve(board, gOppPlayerId, VCF_DEFENCE_NODE_LIMIT, line) > 0;
+        boardUpdate(board, move.row, move.col, EMPTY_SLOT);
+        if (!stillWins) {
+            survivors.candidates[survivors.count++] = move;
+        }
+    }
+
+    // 步骤 3: 用能化解的着法替换根节点候选 (按启发分重新排序)
+    if (survivors.count > 0) {
+        *list = survivors;
+        if (list->count > 1) {
+            sortCandidatesByScore(list);
+        }
+    }
+}
+
+// --- 搜索预算 --- //
+
+/**
+ * @brief 读取毫秒时钟 (原生使用 C11 timespec_get, wasm 使用宿主提供的时钟)
+ * @return 当前时刻 (毫秒)
+ */
+LL getTimeMs() {
+#ifdef GOMOKU_WASM
+    return (LL) gomoku_now_ms();
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (LL) ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+#endif
+}
+
+/**
+ * @brief 所有线程累计的节点数之和 (各线程的计数用原子读, 只在检查点与报告时调用)
+ */
+ULL sumWorkerNodes() {
+    ULL total = 0;
+    for (int t = 0; t < MAX_THREADS; t++) {
+        total += __atomic_load_n(&gWorkers[t].nodes, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+/**
+ * @brief 本次搜索 (或后台思考命中以来) 所有线程搜索的节点数
+ */
+ULL searchNodeCount() {
+    return sumWorkerNodes() - gSearchState.nodeBase;
+}
+
+/**
+ * @brief 开始一次新的搜索: 记录节点计数的起点并根据 gSearchLimits 计算截止时刻 (此时没有线程在搜索)
+ */
+void searchBegin() {
+    gSearchState.nodeBase = sumWorkerNodes();
+    for (int t = 0; t < MAX_THREADS; t++) {
+        gWorkers[t].nextCheckNodes = gWorkers[t].nodes; // 第一个节点就检查一次, 节点预算从头计算
+    }
+    gSearchState.stopped = 0;
+    gSearchState.startMs = getTimeMs();
+    gSearchState.deadlineMs = gSearchLimits.timeLimitMs > 0 ? gSearchState.startMs + gSearchLimits.timeLimitMs : 0;
+}
+
+/**
+ * @brief 本次搜索是否已被中止 (任意线程都可能置位, 使用原子读)
+ */
+int searchStopped() {
+    return __atomic_load_n(&gSearchState.stopped, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 中止本次搜索 (所有线程会在下一个节点返回)
+ */
+void searchStop() {
+    __atomic_store_n(&gSearchState.stopped, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 记录一个搜索节点, 并检查预算是否耗尽
+ * 每个节点只写本线程的计数; 每 TIME_CHECK_INTERVAL + 1 个节点 (剩余的节点预算不多时更频繁,
+ * 单线程时恰好在预算处停止) 才对所有线程的计数求和并读取时钟
+ * @param worker 搜索线程
+ * @return 1 (应立即中止搜索) 或 0 (继续)
+ */
+int searchShouldStop(SearchWorker *worker) {
+    if (searchStopped()) {
+        return 1;
+    }
+
+    const ULL nodes = worker->nodes + 1;
+    __atomic_store_n(&worker->nodes, nodes, __ATOMIC_RELAXED);
+    if (nodes < worker->nextCheckNodes) {
+        return 0;
+    }
+    ULL step = TIME_CHECK_INTERVAL + 1;
+    // 后台思考期间不受预算限制 (命中时主线程先设好新的截止时刻, 再清除此标记)
+    if (!__atomic_load_n(&gSearchState.pondering, __ATOMIC_ACQUIRE)) {
+        const ULL total = searchNodeCount();
+        if (gSearchLimits.nodeLimit > 0 && total >= gSearchLimits.nodeLimit) {
+            searchStop();
+        } else if (gSearchState.deadlineMs > 0 && getTimeMs() >= gSearchState.deadlineMs) {
+            searchStop();
+        } else if (gSearchLimits.nodeLimit > 0) {
+            // 剩余的节点预算平分给各线程, 下一次检查不会越过预算太多
+            const ULL share = (gSearchLimits.nodeLimit - total + (ULL) gThreadCount - 1) / (ULL) gThreadCount;
+            step = share < step ? share : step;
+        }
+    }
+    worker->nextCheckNodes = nodes + step;
+    return searchStopped();
+}
+
+// --- 线程 (仅原生模式) --- //
+#ifndef GOMOKU_WASM
+
+// 线程接口的薄封装: Windows 使用 Win32 线程, 其他平台使用 pthreads
+#ifdef _WIN32
+typedef HANDLE ThreadHandle;
+typedef DWORD (WINAPI *ThreadEntry)(LPVOID);
+typedef SRWLOCK Mutex;
+typedef CONDITION_VARIABLE CondVar;
+#else
+typedef pthread_t ThreadHandle;
+typedef void *(*ThreadEntry)(void *);
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t CondVar;
+#endif
+
+/**
+ * @brief 创建并启动线程
+ * @param handle (出参) 线程句柄
+ * @param entry 线程入口
+ * @param arg 传给入口的参数
+ * @return 1 (成功) 或 0 (失败)
+ */
+int threadStart(ThreadHandle *handle, const ThreadEntry entry, void *arg) {
+#ifdef _WIN32
+    *handle = CreateThread(NULL, 0, entry, arg, 0, NULL);
+    return *handle != NULL;
+#else
+    return pthread_create(handle, NULL, entry, arg) == 0;
+#endif
+}
+
+/**
+ * @brief 等待线程结束并释放句柄
+ * @param handle 线程句柄
+ */
+void threadJoin(const ThreadHandle handle) {
+#ifdef _WIN32
+    WaitForSingleObject(handle, INFINITE);
+    CloseHandle(handle);
+#else
+    pthread_join(handle, NULL);
+#endif
+}
+
+void mutexInit(Mutex *mutex) {
+#ifdef _WIN32
+    InitializeSRWLock(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void mutexDestroy(Mutex *mutex) {
+#ifdef _WIN32
+    (void) mutex; // SRWLOCK 无需释放
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+void mutexLock(Mutex *mutex) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void mutexUnlock(Mutex *mutex) {
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+void condInit(CondVar *cond) {
+#ifdef _WIN32
+    InitializeConditionVariable(cond);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
+}
+
+void condDestroy(CondVar *cond) {
+#ifdef _WIN32
+    (void) cond; // CONDITION_VARIABLE 无需释放
+#else
+    pthread_cond_destroy(cond);
+#endif
+}
+
+/**
+ * @brief 在持有 mutex 的前提下等待条件变量 (返回时重新持有 mutex)
+ */
+void condWait(CondVar *cond, Mutex *mutex) {
+#ifdef _WIN32
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
+
+void condBroadcast(CondVar *cond) {
+#ifdef _WIN32
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+// 线程池: 辅助线程常驻 (gWorkers[1..gPoolSize]), 每次投递一个任务函数, 所有辅助线程各自以自己的 SearchWorker 执行一遍
+typedef void (*PoolJob)(SearchWorker *worker);
+static ThreadHandle gPoolThreads[MAX_THREADS];
+static int gPoolSeenGeneration[MAX_THREADS]; // 各线程已执行过的任务批次
+static Mutex gPoolLock;
+static CondVar gPoolWake; // 投递了新任务 (或要求关闭)
+static CondVar gPoolIdle; // 所有辅助线程都完成了当前任务
+static int gPoolInitialized;
+static int gPoolSize; // 运行中的辅助线程数
+static int gPoolGeneration; // 任务批次编号
+static int gPoolBusy; // 尚未完成当前任务的辅助线程数
+static int gPoolShutdown;
+static PoolJob gPoolJob;
+
+/**
+ * @brief 辅助线程主循环: 等待新任务批次, 执行后报告完成
+ */
+void poolThreadLoop(SearchWorker *worker) {
+    while (1) {
+        mutexLock(&gPoolLock);
+        while (!gPoolShutdown && gPoolGeneration == gPoolSeenGeneration[worker->id]) {
+            condWait(&gPoolWake, &gPoolLock);
+        }
+        if (gPoolShutdown) {
+            mutexUnlock(&gPoolLock);
+            return;
+        }
+        gPoolSeenGeneration[worker->id] = gPoolGeneration;
+        const PoolJob job = gPoolJob;
+        mutexUnlock(&gPoolLock);
+
+        job(worker);
+
+        mutexLock(&gPoolLock);
+        if (--gPoolBusy == 0) {
+            condBroadcast(&gPoolIdle);
+        }
+        mutexUnlock(&gPoolLock);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI poolThreadMain(LPVOID arg) {
+    poolThreadLoop((SearchWorker *) arg);
+    return 0;
+}
+#else
+static void *poolThreadMain(void *arg) {
+    poolThreadLoop((SearchWorker *) arg);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief 调整线程池大小 (只能在没有任务运行时调用); 大小变化时关闭旧线程再重新创建
+ * @param helperCount 需要的辅助线程数
+ */
+void poolResize(const int helperCount) {
+    if (!gPoolInitialized) {
+        mutexInit(&gPoolLock);
+        condInit(&gPoolWake);
+        condInit(&gPoolIdle);
+        gPoolInitialized = 1;
+    }
+    if (helperCount == gPoolSize) {
+        return;
+    }
+
+    // 步骤 1: 关闭现有线程
+    mutexLock(&gPoolLock);
+    gPoolShutdown = 1;
+    condBroadcast(&gPoolWake);
+    mutexUnlock(&gPoolLock);
+    for (int t = 0; t < gPoolSize; t++) {
+        threadJoin(gPoolThreads[t]);
+    }
+    gPoolShutdown = 0;
+    gPoolSize = 0;
+
+    // 步骤 2: 创建新线程 (创建失败时以已创建的线程继续)
+    for (int t = 1; t <= helperCount && t < MAX_THREADS; t++) {
+        gWorkers[t].id = t;
+        gPoolSeenGeneration[t] = gPoolGeneration;
+        if (!threadStart(&gPoolThreads[gPoolSize], poolThreadMain, &gWorkers[t])) {
+            break;
+        }
+        gPoolSize++;
+    }
+}
+
+/**
+ * @brief 向所有辅助线程投递任务 (立即返回, 用 poolWait 等待完成)
+ */
+void poolStart(const PoolJob job) {
+    mutexLock(&gPoolLock);
+    gPoolJob = job;
+    gPoolBusy = gPoolSize;
+    gPoolGeneration++;
+    condBroadcast(&gPoolWake);
+    mutexUnlock(&gPoolLock);
+}
+
+/**
+ * @brief 等待所有辅助线程完成当前任务
+ */
+void poolWait() {
+    mutexLock(&gPoolLock);
+    while (gPoolBusy > 0) {
+        condWait(&gPoolIdle, &gPoolLock);
+    }
+    mutexUnlock(&gPoolLock);
+}
+
+/**
+ * @brief YBWC 分裂点: 某个 alphaBeta 节点的长子搜完后, 剩余兄弟着法由主人线程和空闲辅助线程共同搜索
+ * 分裂点位于主人线程的栈上, 主人线程要等所有辅助线程离开后才返回 (等待期间帮助搜索辅助线程在其下建立的分裂点)
+ */
+typedef struct SplitPoint {
+    Mutex lock; // 保护下面的搜索状态
+    struct SplitPoint *parent; // 主人线程所在的外层分裂点 (剪枝沿此链向内传播)
+    ChessBoard board; // 分裂节点的局面 (辅助线程加入时复制)
+    const CandidateList *list; // 候选着法 (位于主人线程的栈上)
+    int hashMove; // 已作为长子搜过的置换表着法 (MOVE_NONE 表示没有)
+    int nextIndex; // 下一个待分配的着法下标
+    int depth; // 节点的剩余搜索深度
+    int ply; // 节点的层数
+    int player; // 节点上轮到谁
+    LL alpha, beta; // 当前窗口 (随兄弟着法搜完而收窄)
+    LL maxMinEval; // 节点的最高(我方) 最低(对方) 分数
+    int bestMove; // 取得 maxMinEval 的着法
+    int hashType; // 置换表存储类型
+    int searchedCount; // 已搜完的着法数
+    int cutoff; // 已发生剪枝 (原子读写), 子树中的线程应立即返回
+    int helpers; // 正在此分裂点工作的辅助线程数
+} SplitPoint;
+
+// 开放的分裂点 (还有待分配的着法), 空闲的辅助线程从中挑选加入; 由 gSplitLock 保护
+static SplitPoint *gSplitPoints[YBWC_MAX_SPLIT_POINTS];
+static int gSplitCount;
+static Mutex gSplitLock;
+static CondVar gSplitWake; // 出现了新的分裂点, 某个分裂点的辅助线程全部离开 (或要求结束)
+static int gSplitLocksInitialized;
+static int gSplitIdle; // 正在等待分裂点的线程数 (含等待辅助线程的主人线程; 原子读, 用于决定是否值得分裂)
+static int gSplitShutdown;
+
+#endif
+
+// --- 连续威胁 (VCT) 搜索 --- //
+
+/**
+ * @brief 检查 player 在 (row, col) 落子后是否形成活三 (含跳活三)
+ * (使用 analyzeLine 的棋型分类, 调用前需先在该点放上 player 的棋子)
+ * @param board (只读) 棋盘状态
+ * @param row 行
+ * @param col 列
+ * @param player 玩家
+ * @return 1 (形成活三) 或 0
+ */
+int makesOpenThree(const ChessBoard *board, const int row, const int col, const int player) {
+    const Coord pos = {row, col, 0};
+    for (int d = 0; d < 4; d++) {
+        const int pattern = analyzeLine(board, pos, d, player);
+        if (pattern == PATTERN_THREE_OPEN || pattern == PATTERN_JUMP_THREE_OPEN) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 记录一个 VCT 节点并检查预算 (节点数与时间)
+ * @return 1 (预算耗尽) 或 0
+ */
+int vctShouldStop() {
+    if (gVctAborted) {
+        return 1;
+    }
+    gVctNodes++;
+    if (gVctNodes > gVctNodeLimit) {
+        gVctAborted = 1;
+    } else if (gVctDeadlineMs > 0 && (gVctNodes & 255) == 0 && getTimeMs() >= gVctDeadlineMs) {
+        gVctAborted = 1;
+    }
+    return gVctAborted;
+}
+
+int vctAttack(ChessBoard *board, const int attacker, const int depth, Coord *line);
+
+/**
+ * @brief 把 (row, col) 加入守方候选 (已存在则忽略)
+ * @return 新的候选数
+ */
+int addVctDefence(Coord *defences, int count, const int row, const int col) {
+    for (int k = 0; k < count; k++) {
+        if (defences[k].row == row && defences[k].col == col) {
+            return count;
+        }
+    }
+    defences[count].row = row;
+    defences[count].col = col;
+    defences[count].score = 0;
+    return count + 1;
+}
+
+/**
+ * @brief 生成 VCT 攻方着法: 守方有冲四时只能挡, 否则为全部冲四点 (排在前面) 与活三点
+ * (调用前需确认攻方没有成五点)
+ * @param board (可写) 棋盘状态 (试探落子后会恢复)
+ * @param attacker 攻方
+ * @param moves (出参) 攻方着法, 容量至少为 MAX_CANDIDATES
+ * @return 着法数; -1 表示守方已有两个以上成五点 (攻方挡不住)
+ */
+int generateVctThreats(ChessBoard *board, const int attacker, Coord *moves) {
+    const int defender = 3 - attacker;
+    Coord points[2];
+
+    // 步骤 1: 守方有冲四, 攻方必须先挡
+    const int defenderFives = collectFivePoints(board, defender, points, 2);
+    if (defenderFives >= 2) {
+        return -1;
+    }
+    if (defenderFives == 1) {
+        moves[0] = points[0];
+        return 1;
+    }
+
+    // 步骤 2: 扫描冲四点与活三点
+    int moveCount = 0;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (board->cells[CELL_INDEX(i, j)] != EMPTY_SLOT || !hasLineStones(board, i, j, attacker, 2)) {
+                continue;
+            }
+            // 试探落子只做棋型与成五查询, 不必更新哈希与评估
+            boardProbeCell(board, i, j, attacker);
+            const int isFour = hasLineStones(board, i, j, attacker, 3) && collectFivePointsAround(board, i, j, attacker, points, 1) > 0;
+            const int isThree = !isFour && makesOpenThree(board, i, j, attacker);
+            boardProbeCell(board, i, j, EMPTY_SLOT);
+            if (isFour || isThree) {
+                moves[moveCount].row = i;
+                moves[moveCount].col = j;
+                moves[moveCount].score = isFour ? 2 : 1;
+                moveCount++;
+            }
+        }
+    }
+
+    // 步骤 3: 冲四排在活三之前 (稳定插入排序)
+    for (int a = 1; a < moveCount; a++) {
+        const Coord current = moves[a];
+        int b = a - 1;
+        while (b >= 0 && moves[b].score < current.score) {
+            moves[b + 1] = moves[b];
+            b--;
+        }
+        moves[b + 1] = current;
+    }
+    return moveCount;
+}
+
+/**
+ * @brief 生成 VCT 守方着法: 所有可能化解攻方威胁的着法
+ * 守方候选 = 攻方的成五点 (必须挡) 或 攻方在威胁所在线上的冲四点 (挡住活三的各个位置) + 守方的冲四 (反击)
+ * (攻方着法保证此时守方没有成五点, 且攻方的成五点只可能由刚落下的 threat 产生)
+ * @param board (可写) 棋盘状态 (试探落子后会恢复)
+ * @param attacker 攻方
+ * @param threat 攻方刚走的着法
+ * @param defences (出参) 守方着法, 容量至少为 MAX_CANDIDATES
+ * @param winLine (出参) 返回 -1 时写入 "守方任意一挡 + 攻方成五" 两步
+ * @return 着法数; 0 表示这一手不构成威胁; -1 表示攻方已有两个以上成五点 (挡不住)
+ */
+int generateVctDefences(ChessBoard *board, const int attacker, const Coord threat, Coord *defences, Coord *winLine) {
+    const int defender = 3 - attacker;
+    Coord points[2];
+
+    // 步骤 1: 攻方有两个以上成五点 (活四或双四), 挡不住
+    const int attackerFives = collectFivePointsAround(board, threat.row, threat.col, attacker, points, 2);
+    if (attackerFives >= 2) {
+        winLine[0] = points[0];
+        winLine[1] = points[1];
+        return -1;
+    }
+    // 步骤 2: 攻方冲四, 只能挡
+    if (attackerFives == 1) {
+        defences[0] = points[0];
+        return 1;
+    }
+
+    // 步骤 3: 威胁所在的 4 条线上, 攻方的冲四点 (在这些点落子能破坏活三);
+    // 若其中没有能形成活四/双四的点, 说明这一手不是威胁
+    int defenceCount = 0;
+    int hasThreat = 0;
+    for (int d = 0; d < 4; d++) {
+        for (int dist = -4; dist <= 4; dist++) {
+            const int r = threat.row + dist * gDirectionRow[d];
+            const int c = threat.col + dist * gDirectionCol[d];
+            // 距离 4 以内不会越出哨兵边框, 棋盘外的格是 CELL_WALL, 自然跳过
+            if (dist == 0 || board->cells[CELL_INDEX(r, c)] != EMPTY_SLOT) {
+                continue;
+            }
+            // 试探落子只做棋型与成五查询, 不必更新哈希与评估
+            boardProbeCell(board, r, c, attacker);
+            const int fiveCount = collectFivePointsAround(board, r, c, attacker, points, 2);
+            boardProbeCell(board, r, c, EMPTY_SLOT);
+            if (fiveCount >= 1) {
+                defenceCount = addVctDefence(defences, defenceCount, r, c);
+                hasThreat |= fiveCount >= 2;
+            }
+        }
+    }
+    if (!hasThreat) {
+        return 0;
+    }
+
+    // 步骤 4: 守方的冲四 (反击, 攻方必须先挡)
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (board->cells[CELL_INDEX(i, j)] != EMPTY_SLOT || !hasLineStones(board, i, j, defender, 3)) {
+                continue;
+            }
+            boardProbeCell(board, i, j, defender);
+            const int isFour = collectFivePointsAround(board, i, j, defender, points, 1) >= 1;
+            boardProbeCell(board, i, j, EMPTY_SLOT);
+            if (isFour) {
+                defenceCount = addVctDefence(defences, defenceCount, i, j);
+            }
+        }
+    }
+    return defenceCount;
+}
+
+/**
+ * @brief VCT 守方节点: 所有防守都被攻破才算攻方获胜
+ * @param board (可写) 棋盘状态
+ * @param attacker 攻方
+ * @param threat 攻方刚走的着法
+ * @param depth 剩余的攻方步数
+ * @param line (出参) 获胜着法序列 (从守方的着法开始)
+ * @return 获胜序列长度 (> 0 表示攻方获胜), 0 表示守方能化解或超出预算
+ */
+int vctDefend(ChessBoard *board, const int attacker, const Coord threat, const int depth, Coord *line) {
+    const int defender = 3 - attacker;
+
+    // 步骤 1: 生成守方候选
+    Coord defences[MAX_CANDIDATES];
+    const int defenceCount = generateVctDefences(board, attacker, threat, defences, line);
+    if (defenceCount < 0) {
+        return 2;
+    }
+
+    // 步骤 2: 每个防守都必须被攻破
+    int length = 0;
+    for (int k = 0; k < defenceCount; k++) {
+        boardUpdate(board, defences[k].row, defences[k].col, defender);
+        length = vctAttack(board, attacker, depth, line + 1);
+        boardUpdate(board, defences[k].row, defences[k].col, EMPTY_SLOT);
+        if (length == 0) {
+            return 0;
+        }
+        line[0] = defences[k];
+    }
+    return defenceCount > 0 ? length + 1 : 0;
+}
+
+/**
+ * @brief VCT 攻方节点: 只走冲四与活三
+ * @param board (可写) 棋盘状态
+ * @param attacker 攻方
+ * @param depth 剩余的攻方步数
+ * @param line (出参) 获胜着法序列 (攻, 守, 攻 ...)
+ * @return 获胜序列长度 (> 0 表示找到 VCT), 0 表示未找到或超出预算
+ */
+int vctAttack(ChessBoard *board, const int attacker, const int depth, Coord *line) {
+    // 步骤 1: 预算与深度检查
+    if (vctShouldStop() || depth <= 0) {
+        return 0;
+    }
+    // 步骤 2: 攻方有成五点, 直接获胜
+    if (collectFivePoints(board, attacker, line, 1) > 0) {
+        return 1;
+    }
+
+    // 步骤 3: 查询失败缓存
+    const ULL key = board->currentHash ^ gVcfAttackerKeys[attacker] ^ gVcfAttackerKeys[EMPTY_SLOT];
+    VCF_Entry *entry = &gVctCache[key % VCT_CACHE_SIZE];
+    if (entry->key == key && entry->depth >= depth) {
+        return 0;
+    }
+
+    // 步骤 4: 生成攻方着法并逐个尝试
+    Coord moves[MAX_CANDIDATES];
+    const int moveCount = generateVctThreats(board, attacker, moves);
+    for (int k = 0; k < moveCount && !gVctAborted; k++) {
+        boardUpdate(board, moves[k].row, moves[k].col, attacker);
+        const int length = vctDefend(board, attacker, moves[k], depth - 1, line + 1);
+        boardUpdate(board, moves[k].row, moves[k].col, EMPTY_SLOT);
+        if (length > 0) {
+            line[0] = moves[k];
+            return length + 1;
+        }
+    }
+
+    // 步骤 5: 完整搜索后仍无解, 记入缓存
+    if (!gVctAborted) {
+        entry->key = key;
+        entry->depth = depth;
+    }
+    return 0;
+}
+
+/**
+ * @brief VCT 求解入口: 判断 attacker 先走时能否通过连续的冲四/活三取胜
+ * (既用于 determineNextPlay 的预搜索, 也可单独用于局面分析)
+ * @param board (可写) 棋盘状态 (求解结束后恢复原状)
+ * @param attacker 攻方 (即轮到走棋的一方)
+ * @param nodeLimit 节点上限
+ * @param timeLimitMs 时间上限 (毫秒, 0 表示不限)
+ * @param line (出参) 获胜着法序列, 容量至少为 VCT_MAX_LINE + 1
+ * @return 获胜序列长度 (> 0 表示找到 VCT), 0 表示未找到或超出预算
+ */
+int vctSolve(ChessBoard *board, const int attacker, const ULL nodeLimit, const LL timeLimitMs, Coord *line) {
+    gVctNodes = 0;
+    gVctNodeLimit = nodeLimit;
+    gVctDeadlineMs = timeLimitMs > 0 ? getTimeMs() + timeLimitMs : 0;
+    gVctAborted = 0;
+    // 逐步加深: 短的必胜序列代价很低, 应在预算耗尽前先被找到 (浅层失败记录在缓存中, 深层可直接复用)
+    for (int depth = 2; depth <= VCT_MAX_DEPTH && !gVctAborted; depth += 2) {
+        const int length = vctAttack(board, attacker, depth, line);
+        if (length > 0) {
+            return length;
+        }
+    }
+    return 0;
+}
+
+// --- 证明数搜索 (df-pn) --- //
+#ifndef GOMOKU_WASM
+
+/**
+ * @brief 按内存上限 (MB) 分配证明数表 (条目数取不超过上限的最大 2 的幂), 原有内容被丢弃
+ * @param megabytes 内存上限
+ * @return 1 (成功) 或 0 (分配失败)
+ */
+int dfpnAllocate(const int megabytes) {
+    const ULL bytes = (ULL) (megabytes > 0 ? megabytes : 1) << 20;
+    ULL entries = 2;
+    while (entries * 2 * sizeof(DFPN_Entry) <= bytes) {
+        entries *= 2;
+    }
+    free(gDfpnTable);
+    gDfpnTable = (DFPN_Entry *) calloc((size_t) entries, sizeof(DFPN_Entry));
+    gDfpnTableSize = gDfpnTable != NULL ? entries : 0;
+    gDfpnTableMB = gDfpnTable != NULL ? megabytes : 0;
+    return gDfpnTable != NULL;
+}
+
+/**
+ * @brief 计算 df-pn 节点的哈希键
+ * @param hash 局面的 Zobrist 哈希
+ * @param attacker 攻方
+ * @param isAnd 是否为守方 (AND) 节点
+ */
+ULL dfpnKey(const ULL hash, const int attacker, const int isAnd) {
+    return hash ^ gVcfAttackerKeys[attacker] ^ (isAnd ? gDfpnAndKey : 0);
+}
+
+/**
+ * @brief 查询证明数表 (每个键对应相邻的两个槽位), 未命中时返回初始值 pn = dn = 1
+ * @return 命中的条目 (未命中为 NULL)
+ */
+DFPN_Entry *dfpnLookup(const ULL key, unsigned int *pn, unsigned int *dn) {
+    const ULL index = key & (gDfpnTableSize - 2);
+    for (int k = 0; k < 2; k++) {
+        DFPN_Entry *entry = &gDfpnTable[index + k];
+        if (entry->key == key) {
+            *pn = entry->pn;
+            *dn = entry->dn;
+            return entry;
+        }
+    }
+    *pn = 1;
+    *dn = 1;
+    return NULL;
+}
+
+/**
+ * @brief 写入证明数表: 同键覆盖, 否则替换两个槽位中代价较小的一个
+ */
+void dfpnStore(const ULL key, const unsigned int pn, const unsigned int dn, const ULL work) {
+    const ULL index = key & (gDfpnTableSize - 2);
+    DFPN_Entry *slot = &gDfpnTable[index];
+    if (slot->key != key && (gDfpnTable[index + 1].key == key || gDfpnTable[index + 1].work < slot->work)) {
+        slot = &gDfpnTable[index + 1];
+    }
+    slot->key = key;
+    slot->pn = pn;
+    slot->dn = dn;
+    slot->work = work;
+}
+
+/**
+ * @brief 饱和加法 (结果不超过 DFPN_INFINITY)
+ */
+unsigned int dfpnAdd(const unsigned int a, const unsigned int b) {
+    return a + b >= DFPN_INFINITY ? DFPN_INFINITY : a + b;
+}
+
+/**
+ * @brief df-pn 的 MID 过程: 在阈值 (thpn, thdn) 内反复展开最有希望的子节点
+ * 攻方 (OR) 节点的子节点为 generateVctThreats 的着法, 守方 (AND) 节点的子节点为 generateVctDefences 的着法
+ * @param board (可写) 棋盘状态
+ * @param attacker 攻方
+ * @param isAnd 是否为守方 (AND) 节点
+ * @param threat 守方节点: 攻方刚走的着法
+ * @param thpn 证明数阈值
+ * @param thdn 反证数阈值
+ * @param ply 当前层数
+ */
+void dfpnMid(ChessBoard *board, const int attacker, const int isAnd, const Coord threat, const unsigned int thpn, const unsigned int thdn, const int ply) {
+    const ULL key = dfpnKey(board->currentHash, attacker, isAnd);
+    const ULL startNodes = gDfpnNodes;
+
+    // 步骤 1: 节点预算
+    if (++gDfpnNodes > gDfpnNodeLimit) {
+        gDfpnAborted = 1;
+        return;
+    }
+
+    // 步骤 2: 终局判断与子节点生成
+    Coord moves[MAX_CANDIDATES];
+    Coord winLine[2];
+    int moveCount;
+    if (!isAnd) {
+        if (collectFivePoints(board, attacker, winLine, 1) > 0) {
+            dfpnStore(key, 0, DFPN_INFINITY, 1);
+            return;
+        }
+        moveCount = generateVctThreats(board, attacker, moves);
+    } else {
+        moveCount = generateVctDefences(board, attacker, threat, moves, winLine);
+        if (moveCount < 0) {
+            dfpnStore(key, 0, DFPN_INFINITY, 1);
+            return;
+        }
+    }
+    if (moveCount <= 0 || ply >= DFPN_MAX_PLY) {
+        dfpnStore(key, DFPN_INFINITY, 0, 1);
+        return;
+    }
+
+    const int childPiece = isAnd ? 3 - attacker : attacker;
+    while (1) {
+        // 步骤 3: 由子节点汇总 pn/dn, 并找出最有希望的子节点与次优值
+        // OR 节点: pn = min(子 pn), dn = sum(子 dn); AND 节点: pn = sum(子 pn), dn = min(子 dn)
+        unsigned int pn = isAnd ? 0 : DFPN_INFINITY;
+        unsigned int dn = isAnd ? DFPN_INFINITY : 0;
+        unsigned int second = DFPN_INFINITY;
+        unsigned int bestPn = DFPN_INFINITY;
+        unsigned int bestDn = DFPN_INFINITY;
+        int best = 0;
+        for (int k = 0; k < moveCount; k++) {
+            const ULL childHash = board->currentHash ^ gZobristKeys[EMPTY_SLOT][moves[k].row][moves[k].col] ^ gZobristKeys[childPiece][moves[k].row][moves[k].col];
+            unsigned int childPn, childDn;
+            dfpnLookup(dfpnKey(childHash, attacker, !isAnd), &childPn, &childDn);
+            const unsigned int childMin = isAnd ? childDn : childPn;
+            const unsigned int currentMin = isAnd ? dn : pn;
+            if (childMin < currentMin) {
+                second = currentMin;
+                best = k;
+                bestPn = childPn;
+                bestDn = childDn;
+            } else if (childMin < second) {
+                second = childMin;
+            }
+            if (isAnd) {
+                pn = dfpnAdd(pn, childPn);
+                dn = childDn < dn ? childDn : dn;
+            } else {
+                dn = dfpnAdd(dn, childDn);
+                pn = childPn < pn ? childPn : pn;
+            }
+        }
+
+        // 步骤 4: 超出阈值 (或预算耗尽) 时保存并返回
+        if (pn >= thpn || dn >= thdn || gDfpnAborted) {
+            dfpnStore(key, pn, dn, gDfpnNodes - startNodes);
+            return;
+        }
+
+        // 步骤 5: 计算子节点阈值并展开
+        unsigned int childThpn, childThdn;
+        if (isAnd) {
+            childThpn = thpn - pn + bestPn;
+            childThdn = second + 1 < thdn ? second + 1 : thdn;
+        } else {
+            childThpn = second + 1 < thpn ? second + 1 : thpn;
+            childThdn = thdn - dn + bestDn;
+        }
+        boardUpdate(board, moves[best].row, moves[best].col, childPiece);
+        dfpnMid(board, attacker, !isAnd, moves[best], childThpn, childThdn, ply + 1);
+        boardUpdate(board, moves[best].row, moves[best].col, EMPTY_SLOT);
+    }
+}
+
+/**
+ * @brief 从证明数表中提取获胜着法序列 (攻方选已证明的着法, 守方选代价最大的防守)
+ * @param board (可写) 棋盘状态 (提取结束后恢复原状)
+ * @param attacker 攻方
+ * @param line (出参) 着法序列, 容量至少为 DFPN_MAX_LINE
+ * @return 序列长度
+ */
+int dfpnExtractLine(ChessBoard *board, const int attacker, Coord *line) {
+    Coord moves[MAX_CANDIDATES];
+    Coord winLine[2];
+    Coord threat = {-1, -1, 0};
+    int length = 0;
+    int played = 0;
+    int isAnd = 0;
+
+    while (length < DFPN_MAX_LINE) {
+        // 步骤 1: 终局: 攻方成五, 或守方挡不住
+        int moveCount;
+        if (!isAnd) {
+            if (collectFivePoints(board, attacker, &line[length], 1) > 0) {
+                length++;
+                break;
+            }
+            moveCount = generateVctThreats(board, attacker, moves);
+        } else {
+            moveCount = generateVctDefences(board, attacker, threat, moves, winLine);
+            if (moveCount < 0) {
+                for (int k = 0; k < 2 && length < DFPN_MAX_LINE; k++) {
+                    line[length++] = winLine[k];
+                }
+                break;
+            }
+        }
+
+        // 步骤 2: 选择下一步 (子节点必须已被证明)
+        const int childPiece = isAnd ? 3 - attacker : attacker;
+        int best = -1;
+        ULL bestWork = 0;
+        for (int k = 0; k < moveCount; k++) {
+            const ULL childHash = board->currentHash ^ gZobristKeys[EMPTY_SLOT][moves[k].row][moves[k].col] ^ gZobristKeys[childPiece][moves[k].row][moves[k].col];
+            unsigned int childPn, childDn;
+            const DFPN_Entry *entry = dfpnLookup(dfpnKey(childHash, attacker, !isAnd), &childPn, &childDn);
+            if (entry != NULL && childPn == 0 && (best < 0 || (isAnd && entry->work > bestWork))) {
+                best = k;
+                bestWork = entry->work;
+                if (!isAnd) {
+                    break;
+                }
+            }
+        }
+        if (best < 0) {
+            break; // 条目已被替换出表, 序列到此为止
+        }
+
+        // 步骤 3: 走这一步
+        boardUpdate(board, moves[best].row, moves[best].col, childPiece);
+        line[length++] = moves[best];
+        played = length;
+        threat = moves[best];
+        isAnd = !isAnd;
+    }
+
+    // 步骤 4: 恢复棋盘
+    for (int k = played - 1; k >= 0; k--) {
+        boardUpdate(board, line[k].row, line[k].col, EMPTY_SLOT);
+    }
+    return length;
+}
+
+/**
+ * @brief df-pn 求解入口: 证明 attacker 先走时能否通过连续的冲四/活三取胜
+ * (DFPN_DISPROVEN 只表示威胁空间内没有必胜, 并不代表攻方必败)
+ * @param board (可写) 棋盘状态 (求解结束后恢复原状)
+ * @param attacker 攻方 (即轮到走棋的一方)
+ * @param nodeLimit 节点上限
+ * @param line (出参) 获胜着法序列, 容量至少为 DFPN_MAX_LINE
+ * @param lineLength (出参) 获胜序列长度 (未证明时为 0)
+ * @return DFPN_PROVEN / DFPN_DISPROVEN / DFPN_UNKNOWN
+ */
+int dfpnSolve(ChessBoard *board, const int attacker, const ULL nodeLimit, Coord *line, int *lineLength) {
+    *lineLength = 0;
+    if (gDfpnTable == NULL && !dfpnAllocate(DFPN_DEFAULT_MB)) {
+        return DFPN_UNKNOWN;
+    }
+
+    // 步骤 1: 每次求解清空表 (攻方与局面都可能不同)
+    for (ULL i = 0; i < gDfpnTableSize; i++) {
+        gDfpnTable[i].key = 0;
+        gDfpnTable[i].work = 0;
+    }
+    gDfpnNodes = 0;
+    gDfpnNodeLimit = nodeLimit;
+    gDfpnAborted = 0;
+
+    // 步骤 2: 以无穷阈值展开根节点, 直到证明/否证或预算耗尽
+    const Coord none = {-1, -1, 0};
+    dfpnMid(board, attacker, 0, none, DFPN_INFINITY, DFPN_INFINITY, 0);
+    unsigned int pn, dn;
+    dfpnLookup(dfpnKey(board->currentHash, attacker, 0), &pn, &dn);
+
+    // 步骤 3: 汇总结果
+    if (pn == 0) {
+        *lineLength = dfpnExtractLine(board, attacker, line);
+        return DFPN_PROVEN;
+    }
+    return dn == 0 ? DFPN_DISPROVEN : DFPN_UNKNOWN;
+}
+
+#endif
+
+// --- Alpha-Beta 搜索 --- //
+
+/**
+ * @brief 计算后期着法缩减 (LMR) 的层数
+ * 只缩减 "排序靠后 且 安静" 的着法: 前 fullDepthMoves 个着法、杀手着法、
+ * 以及形成或阻挡活三以上棋型的着法都按全深度搜索
+ * @param worker 搜索线程 (提供杀手着法)
+ * @param depth 当前节点剩余深度
+ * @param moveNumber 该着法在本节点中的搜索序号 (从 0 开始)
+ * @param ply 当前层数
+ * @param move 着法 (score 为排序分)
+ * @return 缩减的层数 (0 表示不缩减)
+ */
+int getLateMoveReduction(const SearchWorker *worker, const int depth, const int moveNumber, const int ply, const Coord move) {
+    if (gLmrConfig.reduction <= 0 || depth < gLmrConfig.minDepth || moveNumber < gLmrConfig.fullDepthMoves) {
+        return 0;
+    }
+    if (move.score >= LMR_QUIET_SCORE) {
+        return 0;
+    }
+    if (ply < MAX_PLY) {
+        for (int slot = 0; slot < 2; slot++) {
+            if (worker->ordering.killerMoves[ply][slot].row == move.row && worker->ordering.killerMoves[ply][slot].col == move.col) {
+                return 0;
+            }
+        }
+    }
+    // 缩减后至少保留 1 层
+    return gLmrConfig.reduction < depth - 1 ? gLmrConfig.reduction : depth - 1;
+}
+
+LL alphaBeta(SearchWorker *worker, int depth, int ply, LL alpha, LL beta, int player, Coord lastMove);
+
+/**
+ * @brief 当前搜索是否应当立即返回: 预算耗尽, 或 (YBWC) 所在的任一层分裂点已经发生剪枝
+ * @param worker 搜索线程
+ * @return 1 (中止, 子树结果作废) 或 0
+ */
+int searchAborted(const SearchWorker *worker) {
+    if (searchStopped()) {
+        return 1;
+    }
+#ifndef GOMOKU_WASM
+    for (const struct SplitPoint *sp = worker->splitPoint; sp != NULL; sp = sp->parent) {
+        if (__atomic_load_n(&sp->cutoff, __ATOMIC_RELAXED)) {
+            return 1;
+        }
+    }
+#else
+    (void) worker;
+#endif
+    return 0;
+}
+
+/**
+ * @brief 搜索一个子节点: 落子, 递归搜索, 悔棋
+ * 主变例搜索 (PVS): 只有第一个 (排序最好的) 着法使用完整窗口,
+ * 其余着法先用零窗口试探 "能否改进当前界", 只有试探成功才用完整窗口重新搜索
+ * 后期着法缩减 (LMR): 靠后的安静着法先以缩减后的深度试探, 试探成功再恢复全深度
+ * @param worker 搜索线程
+ * @param move 着法
+ * @param depth 父节点的剩余搜索深度
+ * @param ply 父节点的层数
+ * @param alpha 父节点的 Alpha 值
+ * @param beta 父节点的 Beta 值
+ * @param player 父节点上轮到谁 (落子方)
+ * @param isFirst 是否为第一个着法 (直接使用完整窗口)
+ * @param reduction LMR 缩减层数 (0 表示不缩减)
+ * @return 子节点分数 (搜索被中止时无意义, 调用方需检查 searchAborted())
+ */
+LL searchChild(SearchWorker *worker, const Coord move, const int depth, const int ply, const LL alpha, const LL beta, const int player, const int isFirst, const int reduction) {
+    // 步骤 1: 落子 (更新棋盘和哈希)
+    boardUpdate(&worker->board, move.row, move.col, player);
+
+    // 步骤 2: 递归调用 (深度-1, 轮到对手, 传入刚下的子)
+    LL eval;
+    if (isFirst) {
+        eval = alphaBeta(worker, depth - 1, ply + 1, alpha, beta, 3 - player, move);
+    } else if (player == gAiPlayerId) {
+        // 2A: 我方: 试探能否 > alpha
+        eval = alphaBeta(worker, depth - 1 - reduction, ply + 1, alpha, alpha + 1LL, 3 - player, move);
+        if (!searchAborted(worker) && reduction > 0 && eval > alpha) {
+            eval = alphaBeta(worker, depth - 1, ply + 1, alpha, alpha + 1LL, 3 - player, move);
+        }
+        if (!searchAborted(worker) && eval > alpha && eval < beta) {
+            eval = alphaBeta(worker, depth - 1, ply + 1, alpha, beta, 3 - player, move);
+        }
+    } else {
+        // 2B: 对手: 试探能否 < beta
+        eval = alphaBeta(worker, depth - 1 - reduction, ply + 1, beta - 1LL, beta, 3 - player, move);
+        if (!searchAborted(worker) && reduction > 0 && eval < beta) {
+            eval = alphaBeta(worker, depth - 1, ply + 1, beta - 1LL, beta, 3 - player, move);
+        }
+        if (!searchAborted(worker) && eval < beta && eval > alpha) {
+            eval = alphaBeta(worker, depth - 1, ply + 1, alpha, beta, 3 - player, move);
+        }
+    }
+
+    // 步骤 3: 恢复棋盘和哈希 (悔棋)
+    boardUpdate(&worker->board, move.row, move.col, EMPTY_SLOT);
+    return eval;
+}
+
+/**
+ * @brief 把一个子节点的分数合并进节点状态 (alphaBeta 与 YBWC 分裂点共用)
+ * @param player 节点上轮到谁
+ * @param move 子节点的着法
+ * @param eval 子节点分数
+ * @param alpha (可写) 节点的 Alpha 值
+ * @param beta (可写) 节点的 Beta 值
+ * @param maxMinEval (可写) 节点的最高(我方) 最低(对方) 分数
+ * @param bestMove (可写) 取得 maxMinEval 的着法
+ * @param hashType (可写) 置换表存储类型
+ * @return 1 (发生 Beta 剪枝, 应停止搜索剩余着法) 或 0
+ */
+int mergeChildScore(const int player, const Coord move, const LL eval, LL *alpha, LL *beta, LL *maxMinEval, int *bestMove, int *hashType) {
+    // 步骤 1: 更新此节点的最高/最低分
+    if ((eval > *maxMinEval && player == gAiPlayerId) || (eval < *maxMinEval && player == gOppPlayerId) || *bestMove == MOVE_NONE) {
+        *maxMinEval = eval;
+        *bestMove = move.row * MAX_BOARD_SIZE + move.col;
+    }
+    if (eval > *alpha && player == gAiPlayerId) {
+        // 2A: 更新 Alpha (我方能保证的最低分)
+        *alpha = eval;
+        *hashType = TT_TYPE_EXACT;
+    } else if (eval < *beta && player == gOppPlayerId) {
+        // 2B: 更新 Beta (对手能保证的最高分)
+        *beta = eval;
+        *hashType = TT_TYPE_EXACT;
+    }
+    // 步骤 3: Beta 剪枝
+    if (*beta <= *alpha) {
+        // a.如果我方能保证的分 (alpha) 已经 >= 对手在父节点能保证的分 (beta)
+        // a.那么对手 (Minimizer) 绝不会选择进入这个分支
+
+        // b.如果对手能保证的分 (beta) 已经 <= 我方在父节点能保证的分 (alpha)
+        // b.那么我方 (Maximizer) 绝不会选择进入这个分支
+        *hashType = player == gAiPlayerId ? TT_TYPE_BETA /* 标记为 Beta (下界), 因为分数冲破了 beta*/ : TT_TYPE_ALPHA /* 标记为 Alpha (上界), 因为分数跌破了 alpha */;
+        return 1;
+    }
+    return 0;
+}
+
+#ifndef GOMOKU_WASM
+/**
+ * @brief 是否值得在当前节点分裂 (YBWC 模式, 深度足够, 剩余着法足够, 且有空闲的辅助线程)
+ * @param depth 节点的剩余搜索深度
+ * @param remaining 尚未搜索的着法数
+ */
+int canSplit(const int depth, const int remaining) {
+    return gParallelMode == PARALLEL_YBWC && depth >= YBWC_MIN_SPLIT_DEPTH && remaining >= 2 && __atomic_load_n(&gSplitIdle, __ATOMIC_RELAXED) > 0;
+}
+
+/**
+ * @brief 在分裂点上不断领取并搜索着法, 直到着法分完或发生剪枝 (主人线程与辅助线程都执行)
+ * 领取时复制当前窗口, 兄弟着法搜完后窗口可能已经收窄, 用旧窗口得到的分数仍然正确, 只是剪枝少一些
+ * @param worker 搜索线程 (worker->board 为分裂节点的局面, worker->splitPoint 为 sp)
+ * @param sp 分裂点
+ */
+void searchSplitMoves(SearchWorker *worker, SplitPoint *sp) {
+    while (1) {
+        // 步骤 1: 领取下一个着法, 并复制当前窗口
+        mutexLock(&sp->lock);
+        if (sp->cutoff || sp->nextIndex >= sp->list->count) {
+            mutexUnlock(&sp->lock);
+            return;
+        }
+        const int index = sp->nextIndex++;
+        const LL alpha = sp->alpha;
+        const LL beta = sp->beta;
+        mutexUnlock(&sp->lock);
+
+        const Coord move = sp->list->candidates[index];
+        if (move.row * MAX_BOARD_SIZE + move.col == sp->hashMove) {
+            continue; // 置换表着法已作为长子搜索过
+        }
+
+        // 步骤 2: 零窗口试探 (长子已搜完, 分裂点上的着法都不是第一个)
+        const int moveNumber = index + (sp->hashMove != MOVE_NONE);
+        const int reduction = getLateMoveReduction(worker, sp->depth, moveNumber, sp->ply, move);
+        const LL eval = searchChild(worker, move, sp->depth, sp->ply, alpha, beta, sp->player, 0, reduction);
+        if (searchAborted(worker)) {
+            return; // 预算耗尽, 或本分裂点 (或外层分裂点) 已被其他线程剪枝
+        }
+
+        // 步骤 3: 合并结果, 发生剪枝时通知所有在此分裂点工作的线程
+        mutexLock(&sp->lock);
+        sp->searchedCount++;
+        if (!sp->cutoff && mergeChildScore(sp->player, move, eval, &sp->alpha, &sp->beta, &sp->maxMinEval, &sp->bestMove, &sp->hashType)) {
+            __atomic_store_n(&sp->cutoff, 1, __ATOMIC_RELAXED);
+            recordCutoffMove(worker, sp->ply, sp->player, move, sp->depth);
+        }
+        mutexUnlock(&sp->lock);
+    }
+}
+
+/**
+ * @brief 挑选可加入的分裂点: 还有着法可分且未剪枝, 剩余深度最大的一个 (子树最大, 摊薄加入与复制棋盘的开销)
+ * (调用方持有 gSplitLock)
+ * @param ancestor 非 NULL 时只挑选外层分裂点链中含 ancestor 的分裂点 (主人线程等待时只能帮助自己的子树)
+ * @return 分裂点, 或 NULL
+ */
+static SplitPoint *findSplitPoint(const SplitPoint *ancestor) {
+    SplitPoint *target = NULL;
+    for (int k = 0; k < gSplitCount; k++) {
+        SplitPoint *sp = gSplitPoints[k];
+        if (ancestor != NULL) {
+            const SplitPoint *outer = sp->parent;
+            while (outer != NULL && outer != ancestor) {
+                outer = outer->parent;
+            }
+            if (outer == NULL) {
+                continue;
+            }
+        }
+        mutexLock(&sp->lock);
+        if (!sp->cutoff && sp->nextIndex < sp->list->count && (target == NULL || sp->depth > target->depth)) {
+            target = sp;
+        }
+        mutexUnlock(&sp->lock);
+    }
+    return target;
+}
+
+/**
+ * @brief 作为辅助线程加入分裂点, 搜索到着法分完后离开 (调用前后都持有 gSplitLock, 搜索期间释放)
+ * 分裂点在撤销登记之前加入 (持有 gSplitLock 时它仍在 gSplitPoints 中), 主人线程要等 helpers 归零才返回
+ * @param worker 搜索线程 (局面被改写为分裂节点的局面)
+ * @param target 分裂点
+ */
+static void splitJoin(SearchWorker *worker, SplitPoint *target) {
+    mutexLock(&target->lock);
+    target->helpers++;
+    mutexUnlock(&target->lock);
+    mutexUnlock(&gSplitLock);
+
+    // 复制分裂节点的局面并搜索
+    SplitPoint *const outer = worker->splitPoint;
+    worker->board = target->board;
+    worker->splitPoint = target;
+    searchSplitMoves(worker, target);
+    worker->splitPoint = outer;
+
+    // 离开分裂点 (之后不能再访问 target); 最后一个离开时唤醒等待中的主人线程 (主人在 gSplitWake 上等待)
+    mutexLock(&target->lock);
+    const int last = --target->helpers == 0;
+    mutexUnlock(&target->lock);
+    mutexLock(&gSplitLock);
+    if (last) {
+        condBroadcast(&gSplitWake);
+    }
+}
+
+/**
+ * @brief 在 alphaBeta 节点上分裂: 剩余着法由本线程与空闲的辅助线程并行搜索, 全部结束后把结果写回节点状态
+ * @param worker 搜索线程 (分裂点的主人)
+ * @param list 节点的候选着法
+ * @param firstIndex 第一个未搜索的着法下标
+ * @param hashMove 已搜索过的置换表着法 (MOVE_NONE 表示没有)
+ * @param depth 节点的剩余搜索深度
+ * @param ply 节点的层数
+ * @param player 节点上轮到谁
+ * @param alpha (可写) 节点的 Alpha 值
+ * @param beta (可写) 节点的 Beta 值
+ * @param maxMinEval (可写) 节点的最高(我方) 最低(对方) 分数
+ * @param bestMove (可写) 取得 maxMinEval 的着法
+ * @param hashType (可写) 置换表存储类型
+ * @param searchedCount (可写) 已搜索的着法数
+ * @return 1 (已分裂并搜完剩余着法) 或 0 (分裂点已满, 调用方继续串行搜索)
+ */
+int splitSearch(SearchWorker *worker, const CandidateList *list, const int firstIndex, const int hashMove, const int depth, const int ply, const int player,
+                LL *alpha, LL *beta, LL *maxMinEval, int *bestMove, int *hashType, int *searchedCount) {
+    // 步骤 1: 在栈上建立分裂点 (局面在登记成功后才复制)
+    SplitPoint sp;
+    mutexInit(&sp.lock);
+    sp.parent = worker->splitPoint;
+    sp.list = list;
+    sp.hashMove = hashMove;
+    sp.nextIndex = firstIndex;
+    sp.depth = depth;
+    sp.ply = ply;
+    sp.player = player;
+    sp.alpha = *alpha;
+    sp.beta = *beta;
+    sp.maxMinEval = *maxMinEval;
+    sp.bestMove = *bestMove;
+    sp.hashType = *hashType;
+    sp.searchedCount = *searchedCount;
+    sp.cutoff = 0;
+    sp.helpers = 0;
+
+    // 步骤 2: 登记为开放的分裂点, 复制局面 (辅助线程在 gSplitLock 下加入, 之后才会读取), 唤醒空闲的辅助线程
+    mutexLock(&gSplitLock);
+    if (gSplitCount >= YBWC_MAX_SPLIT_POINTS) {
+        mutexUnlock(&gSplitLock);
+        mutexDestroy(&sp.lock);
+        return 0;
+    }
+    gSplitPoints[gSplitCount++] = &sp;
+    sp.board = worker->board;
+    condBroadcast(&gSplitWake);
+    mutexUnlock(&gSplitLock);
+
+    // 步骤 3: 主人线程同样参与搜索
+    worker->splitPoint = &sp;
+    searchSplitMoves(worker, &sp);
+
+    // 步骤 4: 撤销登记 (之后不会再有线程加入)
+    mutexLock(&gSplitLock);
+    for (int k = 0; k < gSplitCount; k++) {
+        if (gSplitPoints[k] == &sp) {
+            gSplitPoints[k] = gSplitPoints[--gSplitCount];
+            break;
+        }
+    }
+
+    // 步骤 5: 等待已加入的辅助线程离开; 期间加入它们在 sp 的子树中建立的分裂点 (helpful master), 不让尾部退化为串行
+    while (1) {
+        mutexLock(&sp.lock);
+        const int helpers = sp.helpers;
+        mutexUnlock(&sp.lock);
+        if (helpers == 0) {
+            break;
+        }
+        SplitPoint *target = findSplitPoint(&sp);
+        if (target == NULL) {
+            __atomic_add_fetch(&gSplitIdle, 1, __ATOMIC_RELAXED);
+            condWait(&gSplitWake, &gSplitLock);
+            __atomic_sub_fetch(&gSplitIdle, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        splitJoin(worker, target);
+        worker->board = sp.board; // 恢复分裂节点的局面
+    }
+    mutexUnlock(&gSplitLock);
+    worker->splitPoint = sp.parent;
+
+    // 步骤 6: 写回结果
+    *alpha = sp.alpha;
+    *beta = sp.beta;
+    *maxMinEval = sp.maxMinEval;
+    *bestMove = sp.bestMove;
+    *hashType = sp.hashType;
+    *searchedCount = sp.searchedCount;
+    mutexDestroy(&sp.lock);
+    return 1;
+}
+#endif
+
+/**
+ * @brief Alpha-Beta 剪枝搜索 (核心)
+ * @param worker 搜索线程 (在线程私有的 worker->board 上落子和悔棋)
+ * @param depth 剩余搜索深度
+ * @param ply 当前层数 (根节点为 0, 用于杀手着法表)
+ * @param alpha Alpha 值 (我方能保证的最低分)
+ * @param beta Beta 值 (对手能保证的最高分)
+ * @param player 当前轮到谁 (AI 或 Opponent)
+ * @param lastMove 上一步的落子 (用于胜负判断)
+ * @return 当前局面的评估分数 (若搜索被中止, 返回值无意义, 调用方需检查 searchAborted())
+ */
+LL alphaBeta(SearchWorker *worker, const int depth, const int ply, LL alpha, LL beta, const int player, const Coord lastMove) {
+    ChessBoard *board = &worker->board;
+
+    // --- 步骤 0: 预算检查 (时间或节点数耗尽, 或所在的分裂点已被剪枝时立即返回) ---
+    if (searchShouldStop(worker) || searchAborted(worker)) {
+        return 0;
+    }
+
+    // --- 步骤 1: 置换表查找 ---
+    // 在搜索开始时, 立即查询置换表
+    int hashMove;
+    const LL hashVal = ttSearchBoard(board, depth, alpha, beta, &hashMove);
+    if (hashVal > SCORE_MIN - 1LL) {
+        // 如果命中 (分数有效), 直接返回存储的分数, 剪掉整个子树
+        return hashVal;
+    }
+
+    // --- 步骤 2: 胜负判断 (基于上一步) ---
+    // (这是 "达到叶节点" 的一种情况: 游戏已结束)
+    // 检查 *上一步* 的落子 (lastMove) 是否导致了胜利
+
+    // 2a: 如果当前是 AI 走, 检查 对手 的上一步 (lastMove) 是否获胜
     if (player == gAiPlayerId && getPlayerThreat(board, lastMove, gOppPlayerId) >= 1111111111LL) {
         // 对手赢了, 返回一个极低分 (输棋)
         return SCORE_MIN + 1LL; // +1 是为了与 "未命中" 区分
     }
-    // 2b: 如果当前是 对手 走, 检查 AI 的上一步 (lastMove) 是否获胜
-    if (player == gOppPlayerId && getPlayerThreat(board, lastMove, gAiPlayerId) >= 1111111111LL) {
-        // AI 赢了, 返回一个极高分 (赢棋)
-        return SCORE_MAX - 1LL; // -1 是为了与 "未命中" 区分
+    // 2b: 如果当前是 对手 走, 检查 AI 的上一步 (lastMove) 是否获胜
+    if (player == gOppPlayerId && getPlayerThreat(board, lastMove, gAiPlayerId) >= 1111111111LL) {
+        // AI 赢了, 返回一个极高分 (赢棋)
+        return SCORE_MAX - 1LL; // -1 是为了与 "未命中" 区分
+    }
+
+    // --- 步骤 3: 达到搜索深度 (叶节点) ---
+    if (depth == 0) {
+        // 3a: 搜索已达最大深度, 调用静态评估函数
+        const LL boardScore = evaluateBoardScore(board);
+        // 3b: 将评估结果存入置换表 (精确值)
+        ttStoreBoard(board, depth, boardScore, TT_TYPE_EXACT, MOVE_NONE);
+        // 3c: 返回静态评估分
+        return boardScore;
+    }
+
+    // --- 步骤 4: 置换表着法 (Hash Move) ---
+    // 置换表中记录的最佳着法最可能再次引发剪枝, 在生成候选着法之前先搜索它
+    Coord hashCoord = {MOVE_NONE, MOVE_NONE, 0};
+    if (hashMove != MOVE_NONE) {
+        hashCoord.row = hashMove / MAX_BOARD_SIZE;
+        hashCoord.col = hashMove % MAX_BOARD_SIZE;
+        if (hashCoord.row >= BOARD_SIZE || hashCoord.col >= BOARD_SIZE || board->cells[CELL_INDEX(hashCoord.row, hashCoord.col)] != EMPTY_SLOT) {
+            hashMove = MOVE_NONE; // 哈希碰撞导致的非法着法, 忽略
+        }
+    }
+
+    // 4a: 默认的哈希存储类型: 没有任何着法改进窗口时,
+    // 我方节点的分数是上界 (ALPHA), 对手节点的分数是下界 (BETA)
+    int hashType = player == gAiPlayerId ? TT_TYPE_ALPHA : TT_TYPE_BETA;
+
+    // --- 步骤 5: 递归搜索 ---
+    // 初始化为 负无穷(AI) 或 正无穷(对方)
+    LL maxMinEval = player == gAiPlayerId ? SCORE_MIN : SCORE_MAX;
+    int bestMove = MOVE_NONE; // 取得 maxMinEval 的着法 (存入置换表)
+    int searchedCount = 0; // 已搜索的着法数 (用于 PVS 判断是否为第一个着法)
+
+    // 候选着法列表延迟生成: 置换表着法引发剪枝时, 整个生成与排序过程都可以省掉
+    CandidateList list;
+    list.count = 0;
+
+    // 下标 -1 表示置换表着法, 0 起为生成的候选着法
+    for (int i = hashMove != MOVE_NONE ? -1 : 0; i < list.count || i == 0; i++) {
+        // 5-1: 第一次遍历到生成的着法时才生成与排序候选着法
+        if (i == 0) {
+            generateCandidates(worker, board, &list, ply, player);
+            // 无棋可走 (平局或结束): 这是 "达到叶节点" 的另一种情况, 只能评估当前局面
+            if (list.count == 0 && searchedCount == 0) {
+                const LL boardScore = evaluateBoardScore(board);
+                ttStoreBoard(board, depth, boardScore, TT_TYPE_EXACT, MOVE_NONE);
+                return boardScore;
+            }
+            if (list.count == 0) {
+                break;
+            }
+        }
+#ifndef GOMOKU_WASM
+        // 5-1a: YBWC: 长子 (置换表着法或第一个候选) 已搜完, 剩余着法交给分裂点并行搜索
+        if (i >= 0 && searchedCount > 0 && canSplit(depth, list.count - i)) {
+            if (splitSearch(worker, &list, i, hashMove, depth, ply, player, &alpha, &beta, &maxMinEval, &bestMove, &hashType, &searchedCount)) {
+                if (searchAborted(worker)) {
+                    return 0;
+                }
+                break;
+            }
+        }
+#endif
+        const Coord move = i < 0 ? hashCoord : list.candidates[i];
+        // 5-2: 置换表着法已经搜索过, 跳过
+        if (i >= 0 && hashMove != MOVE_NONE && move.row == hashCoord.row && move.col == hashCoord.col) {
+            continue;
+        }
+
+        // 5-3: 落子, 递归搜索 (PVS + LMR), 悔棋
+        const int reduction = searchedCount == 0 || i < 0 ? 0 : getLateMoveReduction(worker, depth, searchedCount, ply, move);
+        const LL eval = searchChild(worker, move, depth, ply, alpha, beta, player, searchedCount == 0, reduction);
+        searchedCount++;
+        // 5-4: 搜索已被中止, 子树结果不完整, 不能写入置换表
+        if (searchAborted(worker)) {
+            return 0;
+        }
+        // 5-5: 更新此节点的分数与窗口; 发生 Beta 剪枝时记录引发剪枝的着法 (供兄弟节点和后续搜索优先尝试), 停止搜索
+        if (mergeChildScore(player, move, eval, &alpha, &beta, &maxMinEval, &bestMove, &hashType)) {
+            recordCutoffMove(worker, ply, player, move, depth);
+            break; // 若发生在置换表着法上, 候选着法根本不会生成
+        }
+    }
+    // 5-6: 存储结果 (连同最佳着法)
+    ttStoreBoard(board, depth, maxMinEval, hashType, bestMove);
+    // 5-7: 返回此节点找到的 最高(我方) 最低(对方) 分数
+    return maxMinEval;
+}
+
+/**
+ * @brief 在给定窗口内搜索根节点的全部候选着法 (AI 为 Maximizer)
+ * 与 alphaBeta 相同, 第一个着法使用完整窗口, 其余着法先做零窗口试探
+ * @param worker 搜索线程 (搜索 worker->rootList, 主线程的列表已排序, 上一轮的最佳着法在首位)
+ * @param depth 子节点的剩余搜索深度
+ * @param alpha 窗口下界
+ * @param beta 窗口上界
+ * @param bestIndex (出参) 分数超过 alpha 的最佳着法下标; 没有着法超过 alpha (fail-low) 时为 -1
+ * @return 根节点分数 (<= alpha 为上界, >= beta 为下界)
+ */
+LL searchRoot(SearchWorker *worker, const int depth, LL alpha, const LL beta, int *bestIndex) {
+    ChessBoard *board = &worker->board;
+    const CandidateList *list = &worker->rootList;
+    LL bestScore = SCORE_MIN;
+    *bestIndex = -1;
+
+    for (int i = 0; i < list->count; i++) {
+        // 步骤 1: 落子 (AI下)
+        boardUpdate(board, list->candidates[i].row, list->candidates[i].col, gAiPlayerId);
+
+        // 步骤 2: 调用 Alpha-Beta (轮到对手 gOppPlayerId); 最后一轮 depth = SEARCH_DEPTH (7), 总共 1+7=8 层
+        LL score;
+        if (i == 0) {
+            score = alphaBeta(worker, depth, 1, alpha, beta, gOppPlayerId, list->candidates[i]);
+        } else {
+            score = alphaBeta(worker, depth, 1, alpha, alpha + 1LL, gOppPlayerId, list->candidates[i]);
+            if (!searchStopped() && score > alpha && score < beta) {
+                score = alphaBeta(worker, depth, 1, alpha, beta, gOppPlayerId, list->candidates[i]);
+            }
+        }
+
+        // 步骤 3: 悔棋
+        boardUpdate(board, list->candidates[i].row, list->candidates[i].col, EMPTY_SLOT);
+
+        // 步骤 4: 预算耗尽: 这一个着法的分数不完整, 丢弃
+        if (searchStopped()) {
+            break;
+        }
+
+        // 步骤 5: 比较并更新最佳着法
+        if (score > bestScore) {
+            bestScore = score;
+        }
+        if (score > alpha) {
+            alpha = score;
+            *bestIndex = i;
+        }
+        if (alpha >= beta) {
+            break; // fail-high, 由调用方扩大窗口重新搜索
+        }
+    }
+    return bestScore;
+}
+
+#ifndef GOMOKU_WASM
+// Lazy SMP: 本次搜索的迭代加深范围
+static int gHelperFirstDepth;
+static int gHelperMaxDepth;
+
+/**
+ * @brief 辅助线程的迭代加深 (Lazy SMP)
+ * 奇数编号的线程比主线程提前一轮深度, 各线程的根节点顺序也相互错开,
+ * 使它们尽量填充主线程稍后才会用到的置换表条目; 搜索结果只通过置换表生效
+ * @param worker 辅助线程
+ */
+void helperSearch(SearchWorker *worker) {
+    const int firstDepth = gHelperFirstDepth + (worker->id % 2) * ID_DEPTH_STEP;
+    for (int depth = firstDepth; depth <= gHelperMaxDepth && !searchStopped(); depth += ID_DEPTH_STEP) {
+        int index;
+        searchRoot(worker, depth, SCORE_MIN, SCORE_MAX, &index);
+        // 本轮的最佳着法移到首位, 下一轮优先搜索
+        if (index > 0 && !searchStopped()) {
+            const Coord best = worker->rootList.candidates[index];
+            for (int i = index; i > 0; i--) {
+                worker->rootList.candidates[i] = worker->rootList.candidates[i - 1];
+            }
+            worker->rootList.candidates[0] = best;
+        }
+    }
+}
+
+/**
+ * @brief 让线程池中的辅助线程开始 Lazy SMP 搜索
+ * @param board (只读) 根节点棋盘 (每个线程复制一份)
+ * @param list 主线程的根节点候选着法 (辅助线程按线程编号轮转)
+ * @param firstDepth 迭代加深的起始深度
+ * @param maxDepth 迭代加深的最大深度
+ */
+void startSearchHelpers(const ChessBoard *board, const CandidateList *list, const int firstDepth, const int maxDepth) {
+    gHelperFirstDepth = firstDepth;
+    gHelperMaxDepth = maxDepth;
+    for (int t = 1; t <= gPoolSize; t++) {
+        SearchWorker *worker = &gWorkers[t];
+        worker->board = *board;
+        worker->rootList.count = list->count;
+        for (int k = 0; k < list->count; k++) {
+            worker->rootList.candidates[k] = list->candidates[(k + t) % list->count];
+        }
+    }
+    poolStart(helperSearch);
+}
+
+/**
+ * @brief 中止搜索并等待所有辅助线程结束本次任务
+ */
+void stopSearchHelpers() {
+    searchStop();
+    poolWait();
+}
+
+/**
+ * @brief YBWC 辅助线程: 等待开放的分裂点, 加入后与主人线程一起搜索剩余着法, 直到 stopSplitHelpers
+ * 有多个分裂点时优先加入剩余深度最大的 (见 findSplitPoint)
+ * @param worker 辅助线程
+ */
+void splitHelperLoop(SearchWorker *worker) {
+    mutexLock(&gSplitLock);
+    worker->splitPoint = NULL;
+    while (!gSplitShutdown) {
+        // 步骤 1: 挑选还有着法可分且未剪枝的分裂点
+        SplitPoint *target = findSplitPoint(NULL);
+        if (target == NULL) {
+            __atomic_add_fetch(&gSplitIdle, 1, __ATOMIC_RELAXED);
+            condWait(&gSplitWake, &gSplitLock);
+            __atomic_sub_fetch(&gSplitIdle, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        // 步骤 2: 加入, 搜索, 离开
+        splitJoin(worker, target);
+    }
+    mutexUnlock(&gSplitLock);
+}
+
+/**
+ * @brief 让线程池中的辅助线程进入 YBWC 等待状态 (之后主线程的 alphaBeta 即可分裂)
+ */
+void startSplitHelpers() {
+    if (!gSplitLocksInitialized) {
+        mutexInit(&gSplitLock);
+        condInit(&gSplitWake);
+        gSplitLocksInitialized = 1;
+    }
+    gSplitCount = 0;
+    gSplitShutdown = 0;
+    poolStart(splitHelperLoop);
+}
+
+/**
+ * @brief 结束 YBWC 辅助线程 (主线程的搜索已返回, 不再有开放的分裂点)
+ */
+void stopSplitHelpers() {
+    mutexLock(&gSplitLock);
+    gSplitShutdown = 1;
+    condBroadcast(&gSplitWake);
+    mutexUnlock(&gSplitLock);
+    poolWait();
+}
+
+/**
+ * @brief 工作窃取任务队列: 每个线程一个, 本线程从头部取任务 (下标小的先搜, 结果按下标顺序合并), 其他线程从尾部窃取
+ */
+typedef struct {
+    Mutex lock;
+    int tasks[MAX_CANDIDATES]; // 任务 (根节点着法下标, 从头到尾递增)
+    int head; // 本线程取任务的一端 (最早放入的任务)
+    int tail; // 窃取端
+} TaskDeque;
+
+/**
+ * @brief 根节点并行搜索的共享状态 (由 gRootJob.lock 保护)
+ */
+typedef struct {
+    Mutex lock;
+    int depth; // 子节点的剩余搜索深度
+    LL alpha; // 已按下标顺序合并的着法得到的界 (与串行搜索到同一下标时的 alpha 相同)
+    LL beta; // 窗口上界
+    LL bestScore; // 已合并着法中的最高分 (含 fail-low 的上界)
+    int bestIndex; // 分数超过初始 alpha 的最佳着法下标 (-1 表示没有)
+    int cutoff; // 已 fail-high, 剩余任务直接丢弃
+    int nextMerge; // 下一个待合并的着法下标 (之前的着法都已合并)
+    int merging; // 有线程正在合并 (合并中可能解锁重新搜索, 其他线程只登记结果)
+    LL scores[MAX_CANDIDATES]; // 已搜完着法的分数
+    LL searchAlpha[MAX_CANDIDATES]; // 搜索该着法时使用的 alpha
+    unsigned char finished[MAX_CANDIDATES]; // 该着法已搜完, 等待合并
+} RootJob;
+
+static TaskDeque gTaskDeques[MAX_THREADS];
+static RootJob gRootJob;
+static int gRootLocksInitialized;
+// 主线程搜完第一个根着法后的排序表: 其余根着法都从这份快照开始搜索, 结果与由哪个线程搜索无关
+static OrderingTables gRootOrdering;
+
+/**
+ * @brief 取一个任务: 先取自己队列的头部, 空了再依次从其他线程队列的尾部窃取
+ * @param id 线程编号
+ * @param task (出参) 任务
+ * @return 1 (取到) 或 0 (所有队列都空了)
+ */
+int takeRootTask(const int id, int *task) {
+    const int threadCount = gPoolSize + 1;
+    for (int k = 0; k < threadCount; k++) {
+        TaskDeque *deque = &gTaskDeques[(id + k) % threadCount];
+        mutexLock(&deque->lock);
+        const int found = deque->tail > deque->head;
+        if (found) {
+            *task = k == 0 ? deque->tasks[deque->head++] : deque->tasks[--deque->tail];
+        }
+        mutexUnlock(&deque->lock);
+        if (found) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 以根节点窗口 [alpha, beta] 搜索一个根着法 (从排序快照开始, 先零窗口试探, 能改进 alpha 时再用完整窗口)
+ * @param worker 搜索线程 (棋盘为根节点局面)
+ * @param index 根节点着法下标 (gWorkers[0].rootList)
+ * @param alpha 窗口下界
+ * @return 分数 (预算耗尽时无意义)
+ */
+static LL searchRootMove(SearchWorker *worker, const int index, const LL alpha) {
+    const Coord move = gWorkers[0].rootList.candidates[index];
+    const LL beta = gRootJob.beta;
+    worker->ordering = gRootOrdering;
+    boardUpdate(&worker->board, move.row, move.col, gAiPlayerId);
+    LL score = alphaBeta(worker, gRootJob.depth, 1, alpha, alpha + 1LL, gOppPlayerId, move);
+    if (!searchStopped() && score > alpha && score < beta) {
+        score = alphaBeta(worker, gRootJob.depth, 1, alpha, beta, gOppPlayerId, move);
     }
+    boardUpdate(&worker->board, move.row, move.col, EMPTY_SLOT);
+    return score;
+}
 
-    // --- 步骤 3: 达到搜索深度 (叶节点) ---
-    if (depth == 0) {
-        // 3a: 搜索已达最大深度, 调用静态评估函数
-        const LL boardScore = evaluateBoardScore(board);
-        // 3b: 将评估结果存入置换表 (精确值)
-        ttStore(board->currentHash, depth, boardScore, TT_TYPE_EXACT);
-        // 3c: 返回静态评估分
-        return boardScore;
+/**
+ * @brief 按下标顺序合并已搜完的根着法 (调用时持有 gRootJob.lock)
+ * 合并规则与串行的 searchRoot 相同; 搜索时使用的 alpha 已被前面的着法提高的结果,
+ * 由合并线程以当前 alpha 重新搜索, 所以每个着法都以串行搜索中相同的窗口计分
+ * @param worker 搜索线程
+ */
+static void mergeRootResults(SearchWorker *worker) {
+    if (gRootJob.merging) {
+        return; // 正在合并的线程会继续合并本线程登记的结果
+    }
+    gRootJob.merging = 1;
+    const int count = gWorkers[0].rootList.count;
+    while (!gRootJob.cutoff && gRootJob.nextMerge < count && gRootJob.finished[gRootJob.nextMerge]) {
+        const int index = gRootJob.nextMerge;
+        // 步骤 1: 窗口已过时, 以当前 alpha 重新搜索 (合并中 alpha 只由本线程修改, 可以解锁)
+        if (gRootJob.searchAlpha[index] != gRootJob.alpha) {
+            const LL alpha = gRootJob.alpha;
+            mutexUnlock(&gRootJob.lock);
+            const LL score = searchRootMove(worker, index, alpha);
+            mutexLock(&gRootJob.lock);
+            if (searchStopped()) {
+                break; // 分数不完整, 丢弃
+            }
+            gRootJob.scores[index] = score;
+            gRootJob.searchAlpha[index] = alpha;
+        }
+        // 步骤 2: 合并 (分数相同时下标小的着法优先, 与串行搜索一致)
+        const LL score = gRootJob.scores[index];
+        if (score > gRootJob.bestScore) {
+            gRootJob.bestScore = score;
+        }
+        if (score > gRootJob.alpha) {
+            gRootJob.alpha = score;
+            gRootJob.bestIndex = index;
+        }
+        if (gRootJob.alpha >= gRootJob.beta) {
+            __atomic_store_n(&gRootJob.cutoff, 1, __ATOMIC_RELAXED);
+        }
+        gRootJob.nextMerge++;
     }
+    gRootJob.merging = 0;
+}
 
-    // --- 步骤 4: 生成与排序候选着法 ---
-    CandidateList list;
-    generateCandidates(board, &list);
+/**
+ * @brief 搜索一个根节点着法, 登记结果并尝试按下标顺序合并
+ * @param worker 搜索线程
+ * @param index 根节点着法下标 (gWorkers[0].rootList)
+ */
+void runRootTask(SearchWorker *worker, const int index) {
+    // 步骤 1: 读取已合并的界 (之后可能被前面的着法提高, 合并时会重新搜索)
+    mutexLock(&gRootJob.lock);
+    const LL alpha = gRootJob.alpha;
+    mutexUnlock(&gRootJob.lock);
+
+    // 步骤 2: 搜索
+    const LL score = searchRootMove(worker, index, alpha);
+    if (searchStopped()) {
+        return; // 分数不完整, 丢弃
+    }
 
-    // 4a: 默认的哈希存储类型为 ALPHA (下界)
-    // (表示我们至少找到了一个分数为 alpha, 但可能被 Beta 剪枝)
-    int hashType = TT_TYPE_ALPHA;
+    // 步骤 3: 登记并合并结果
+    mutexLock(&gRootJob.lock);
+    gRootJob.scores[index] = score;
+    gRootJob.searchAlpha[index] = alpha;
+    gRootJob.finished[index] = 1;
+    mergeRootResults(worker);
+    mutexUnlock(&gRootJob.lock);
+}
 
-    // --- 步骤 5: 无棋可走 (平局或结束) ---
-    // (这是 "达到叶节点" 的另一种情况: 棋盘已满)
-    if (list.count == 0) {
-        // 5a: 没有候选着法, 只能评估当前局面
-        const LL boardScore = evaluateBoardScore(board);
-        // 5b: 存入置换表
-        ttStore(board->currentHash, depth, boardScore, TT_TYPE_EXACT);
-        // 5c: 返回分数
-        return boardScore;
+/**
+ * @brief 根节点并行的任务循环 (主线程与辅助线程都执行)
+ * @param worker 搜索线程
+ */
+void rootTaskLoop(SearchWorker *worker) {
+    int task;
+    while (!searchStopped() && !__atomic_load_n(&gRootJob.cutoff, __ATOMIC_RELAXED) && takeRootTask(worker->id, &task)) {
+        runRootTask(worker, task);
     }
+}
 
-    // --- 步骤 6: 递归搜索 ---
-    // 初始化为 负无穷(AI) 或 正无穷(对方)
-    LL maxMinEval = player == gAiPlayerId ? SCORE_MIN : SCORE_MAX;
+/**
+ * @brief 根节点并行版的 searchRoot (接口与返回值约定相同)
+ * 长子 (第一个着法) 由主线程以完整窗口搜索得到初始界, 其余着法轮流放入各线程的任务队列,
+ * 各线程取完自己的任务后从其他线程窃取; 结果按下标顺序合并, 每个着法都以串行搜索中相同的窗口计分,
+ * 并从同一份排序快照开始搜索, 选出的着法与线程数和任务的执行顺序无关
+ * @param mainWorker 主线程 (根节点列表与棋盘)
+ * @param depth 子节点的剩余搜索深度
+ * @param alpha 窗口下界
+ * @param beta 窗口上界
+ * @param bestIndex (出参) 分数超过 alpha 的最佳着法下标; 没有时为 -1
+ * @return 根节点分数 (<= alpha 为上界, >= beta 为下界)
+ */
+LL searchRootParallel(SearchWorker *mainWorker, const int depth, const LL alpha, const LL beta, int *bestIndex) {
+    const CandidateList *list = &mainWorker->rootList;
+    const int threadCount = gPoolSize + 1;
+    if (!gRootLocksInitialized) {
+        mutexInit(&gRootJob.lock);
+        for (int t = 0; t < MAX_THREADS; t++) {
+            mutexInit(&gTaskDeques[t].lock);
+        }
+        gRootLocksInitialized = 1;
+    }
 
-    // 遍历所有 (已排序的) 候选着法
-    for (int i = 0; i < list.count; i++) {
-        // 6-1: 落子 (更新棋盘和哈希)
-        boardUpdate(board, list.candidates[i].row, list.candidates[i].col, player);
-        // 6-2: 递归调用 (深度-1, 轮到对手, 传入刚下的子)
-        const LL eval = alphaBeta(board, depth - 1, alpha, beta, 3 - player, list.candidates[i]);
-        // 6-3: 恢复棋盘和哈希 (悔棋)
-        boardUpdate(board, list.candidates[i].row, list.candidates[i].col, EMPTY_SLOT);
-        // 6-4: 更新此节点的最高/最低分
-        if ((eval > maxMinEval && player == gAiPlayerId) || (eval < maxMinEval && player == gOppPlayerId)) {
-            maxMinEval = eval;
-        }
-        if (eval > alpha && player == gAiPlayerId) {
-            // 6-5A: 更新 Alpha (我方能保证的最低分)
-            alpha = eval;
-            hashType = TT_TYPE_EXACT;
-        } else if (eval < beta && player == gOppPlayerId) {
-            // 6-5B: 更新 Beta (对手能保证的最高分)
-            beta = eval;
-            hashType = TT_TYPE_EXACT;
-        }
-        // 6-6: Beta 剪枝
-        if (beta <= alpha) {
-            // a.如果我方能保证的分 (alpha) 已经 >= 对手在父节点能保证的分 (beta)
-            // a.那么对手 (Minimizer) 绝不会选择进入这个分支
-
-            // b.如果对手能保证的分 (beta) 已经 <= 我方在父节点能保证的分 (alpha)
-            // b.那么我方 (Maximizer) 绝不会选择进入这个分支
-            hashType = player == gAiPlayerId ? TT_TYPE_BETA /* 标记为 Beta (上界), 因为分数冲破了 beta*/ : TT_TYPE_ALPHA /* 标记为 Alpha (下界), 因为分数跌破了 alpha */;
-            break; // 停止搜索
-        }
-    }
-    // 6-7: 存储结果
-    ttStore(board->currentHash, depth, maxMinEval, hashType);
-    // 6-8: 返回此节点找到的 最高(我方) 最低(对方) 分数
-    return maxMinEval;
+    // 步骤 1: 主线程以完整窗口搜索第一个着法
+    const Coord first = list->candidates[0];
+    boardUpdate(&mainWorker->board, first.row, first.col, gAiPlayerId);
+    const LL firstScore = alphaBeta(mainWorker, depth, 1, alpha, beta, gOppPlayerId, first);
+    boardUpdate(&mainWorker->board, first.row, first.col, EMPTY_SLOT);
+    *bestIndex = -1;
+    if (searchStopped()) {
+        return SCORE_MIN;
+    }
+
+    // 步骤 2: 保存排序快照, 初始化共享状态 (此时辅助线程都在等待, 无需加锁)
+    gRootOrdering = mainWorker->ordering;
+    gRootJob.depth = depth;
+    gRootJob.alpha = firstScore > alpha ? firstScore : alpha;
+    gRootJob.beta = beta;
+    gRootJob.bestScore = firstScore;
+    gRootJob.bestIndex = firstScore > alpha ? 0 : -1;
+    gRootJob.cutoff = gRootJob.alpha >= beta;
+    gRootJob.nextMerge = 1;
+    gRootJob.merging = 0;
+    for (int i = 0; i < list->count; i++) {
+        gRootJob.finished[i] = 0;
+    }
+
+    // 步骤 3: 其余着法轮流分配到各线程的任务队列, 所有线程一起执行
+    if (!gRootJob.cutoff && list->count > 1) {
+        for (int t = 0; t < threadCount; t++) {
+            gTaskDeques[t].head = 0;
+            gTaskDeques[t].tail = 0;
+            gWorkers[t].board = mainWorker->board;
+        }
+        for (int i = 1; i < list->count; i++) {
+            TaskDeque *deque = &gTaskDeques[(i - 1) % threadCount];
+            deque->tasks[deque->tail++] = i;
+        }
+        poolStart(rootTaskLoop);
+        rootTaskLoop(mainWorker);
+        poolWait();
+        // 主线程回到快照, 下一轮的排序表与任务由哪个线程执行无关
+        mainWorker->ordering = gRootOrdering;
+    }
+
+    *bestIndex = gRootJob.bestIndex;
+    return gRootJob.bestScore;
 }
+#endif
 
 /**
  * @brief 寻找最佳着法 (搜索入口)
  * (这是 Alpha-Beta 的 "根节点" )
+ * 使用迭代加深: 从浅到深逐轮搜索, 每完成一轮就更新最佳着法,
+ * 预算 (gSearchLimits) 耗尽时中止当前轮并返回已完成轮次的结果.
+ * 每轮以上一轮分数为中心设置期望窗口 (Aspiration Window), 落在窗口外时逐步放宽重新搜索
  * @param board (可写) 当前的棋盘状态
  * @return 最佳着法 (Coord)
  */
 Coord determineNextPlay(ChessBoard *board) {
-    // 步骤 1: 为本次决策清空置换表 (可选, 但通常是好的)
-    clearTranspositionTable();
+    // 步骤 1: 置换表进入新的一代 (上一步与后台思考的结果继续沿用), 并启动计时
+    // 后台思考的搜索由 ponderStart 启动计时
+    ttNewSearch();
+    if (!gPonderSearch) {
+        searchBegin();
+    }
 
-    // 步骤 2: 生成第一层 (根节点) 的候选着法
-    CandidateList list;
-    generateCandidates(board, &list);
+    // 步骤 1a: 一步成五或唯一的必堵点无需搜索 (只扫描空点的四个方向, 微秒级)
+    Coord forcedMove;
+    if (findForcedMove(board, &forcedMove)) {
+        return forcedMove;
+    }
+
+    // 步骤 2: 生成第一层 (根节点) 的候选着法 (主线程的棋盘副本与根节点列表)
+    SearchWorker *mainWorker = &gWorkers[0];
+    CandidateList *list = &mainWorker->rootList;
+    mainWorker->id = 0;
+    mainWorker->board = *board;
+#ifndef GOMOKU_WASM
+    poolResize(gThreadCount - 1);
+    for (int t = 1; t <= gPoolSize; t++) {
+        resetOrderingHeuristics(&gWorkers[t]);
+    }
+#endif
+    resetOrderingHeuristics(mainWorker);
+    generateCandidates(mainWorker, board, list, 0, gAiPlayerId);
+
+    // 步骤 2a: VCF 预搜索 (只走冲四的窄搜索, 代价远低于全宽度搜索)
+    // 我方有连续冲四胜则立即返回; 对手有则只保留能化解它的防守着法
+    if (list->count > 0) {
+        Coord vcfLine[VCF_MAX_LINE];
+        if (vcfSolve(board, gAiPlayerId, VCF_NODE_LIMIT, vcfLine) > 0) {
+            return vcfLine[0];
+        }
+        const int oppLineLength = vcfSolve(board, gOppPlayerId, VCF_NODE_LIMIT, vcfLine);
+        if (oppLineLength > 0) {
+            restrictToVcfDefences(board, list, vcfLine, oppLineLength);
+        } else {
+            // 步骤 2b: 对手没有 VCF 时再尝试 VCT 预搜索 (冲四 + 活三), 预算取自本步剩余的预算:
+            // 限时的情况下最多用剩余时间的 1/VCT_TIME_SHARE (且不超过 VCT_TIME_LIMIT_MS), 否则 (固定深度, BENCH, 后台思考) 只受节点上限约束;
+            // 节点计入本步的节点数 (节点预算与报告的节点数都包括 VCT)
+            LL vctTimeMs = 0; // 0 表示不限时
+            ULL vctNodeLimit = VCT_NODE_LIMIT;
+            if (!__atomic_load_n(&gSearchState.pondering, __ATOMIC_ACQUIRE)) {
+                if (gSearchState.deadlineMs > 0) {
+                    const LL share = (gSearchState.deadlineMs - getTimeMs()) / VCT_TIME_SHARE;
+                    vctTimeMs = share < VCT_TIME_LIMIT_MS ? share : VCT_TIME_LIMIT_MS;
+                    if (vctTimeMs <= 0) {
+                        vctNodeLimit = 0; // 剩余时间不足, 跳过
+                    }
+                }
+                if (gSearchLimits.nodeLimit > 0) {
+                    const ULL used = searchNodeCount();
+                    const ULL remaining = gSearchLimits.nodeLimit > used ? gSearchLimits.nodeLimit - used : 0;
+                    vctNodeLimit = remaining < vctNodeLimit ? remaining : vctNodeLimit;
+                }
+            }
+            if (vctNodeLimit > 0) {
+                Coord vctLine[VCT_MAX_LINE + 1];
+                const int vctLength = vctSolve(board, gAiPlayerId, vctNodeLimit, vctTimeMs, vctLine);
+                __atomic_store_n(&mainWorker->nodes, mainWorker->nodes + gVctNodes, __ATOMIC_RELAXED);
+                if (vctLength > 0) {
+                    return vctLine[0];
+                }
+            }
+        }
+    }
 
-    // 步骤 3: 初始化最佳分数和最佳着法
-    LL bestScore = SCORE_MIN; // AI 是 Maximizer, 寻找最高分
+    // 步骤 3: 初始化最佳着法
     Coord bestMove = {-1, -1, 0}; // 默认无效着法
 
     // 步骤 4: 设置保底着法 (如果列表非空)
-    if (list.count > 0) {
-        bestMove = list.candidates[0]; // 至少返回排序后的第一个 (最好的)
+    if (list->count > 0) {
+        bestMove = list->candidates[0]; // 至少返回排序后的第一个 (最好的)
+    }
+    // 只有一个候选时无需搜索
+    if (list->count <= 1) {
+        return bestMove;
     }
 
-    // 步骤 5: 迭代第一层 (模拟 Alpha-Beta 的根节点)
-    for (int i = 0; i < list.count; i++) {
-        // 步骤 5a: 落子 (AI下)
-        boardUpdate(board, list.candidates[i].row, list.candidates[i].col, gAiPlayerId);
+    // 步骤 5: 迭代加深 (起始深度与 maxDepth 同奇偶, 每轮加深 ID_DEPTH_STEP 层)
+    const int maxDepth = gSearchLimits.maxDepth > 0 ? gSearchLimits.maxDepth : 1;
+    const int firstDepth = (maxDepth - 1) % ID_DEPTH_STEP + 1;
+#ifndef GOMOKU_WASM
+    // Lazy SMP: 辅助线程与主线程同时搜索, 通过共享置换表互相加速; 最终着法只由主线程决定
+    // 根节点并行: 辅助线程只在 searchRootParallel 内部参与搜索
+    // YBWC: 辅助线程等待 alphaBeta 建立分裂点, 加入后并行搜索长子之外的兄弟着法
+    const int lazyHelpers = gPoolSize > 0 && gParallelMode == PARALLEL_LAZY;
+    const int parallelRoot = gPoolSize > 0 && gParallelMode == PARALLEL_ROOT;
+    const int splitHelpers = gPoolSize > 0 && gParallelMode == PARALLEL_YBWC;
+    if (lazyHelpers) {
+        startSearchHelpers(board, list, firstDepth, maxDepth);
+    }
+    if (splitHelpers) {
+        startSplitHelpers();
+    }
+#endif
+    LL previousScore = 0;
+    for (int depth = firstDepth; depth <= maxDepth; depth += ID_DEPTH_STEP) {
+        // 步骤 5a: 设置期望窗口 (第一轮或上一轮已分出胜负时使用完整窗口)
+        LL window = ASPIRATION_WINDOW;
+        LL alpha = SCORE_MIN;
+        LL beta = SCORE_MAX;
+        if (depth > firstDepth && previousScore > -SCORE_FIVE && previousScore < SCORE_FIVE) {
+            alpha = previousScore - window;
+            beta = previousScore + window;
+        }
 
-        // 步骤 5b: 调用 Alpha-Beta (注意: 深度是 SEARCH_DEPTH (7), 轮到对手 gOppPlayerId)
-        // 这将启动一个 7 层的搜索 (总共 1+7=8 层)
-        const LL score = alphaBeta(board, SEARCH_DEPTH, SCORE_MIN, SCORE_MAX, gOppPlayerId, list.candidates[i]);
+        LL score;
+        int iterBestIndex;
+        while (1) {
+            // 步骤 5b: 在当前窗口内搜索根节点
+            int index;
+#ifndef GOMOKU_WASM
+            score = parallelRoot ? searchRootParallel(mainWorker, depth, alpha, beta, &index) : searchRoot(mainWorker, depth, alpha, beta, &index);
+#else
+            score = searchRoot(mainWorker, depth, alpha, beta, &index);
+#endif
+            iterBestIndex = index;
 
-        // 步骤 5c: 悔棋
-        boardUpdate(board, list.candidates[i].row, list.candidates[i].col, EMPTY_SLOT);
+            // 步骤 5c: 预算耗尽 或 分数落在窗口内 (精确值), 本轮结束
+            if (searchStopped() || (score > alpha && score < beta)) {
+                break;
+            }
+            // 步骤 5d: 落在窗口外, 放宽对应一侧重新搜索 (窗口过大时直接放开到极值)
+            window *= ASPIRATION_GROWTH;
+            if (score <= alpha && alpha > SCORE_MIN) {
+                alpha = window < SCORE_FIVE ? score - window : SCORE_MIN;
+            } else if (score >= beta && beta < SCORE_MAX) {
+                bestMove = list->candidates[index]; // fail-high 的着法已优于其余着法, 先行采纳
+                beta = window < SCORE_FIVE ? score + window : SCORE_MAX;
+            } else {
+                break;
+            }
+        }
 
-        // 步骤 5d: 比较并更新最佳着法
-        if (score > bestScore) {
-            bestScore = score; // 找到了一个更好的分数
-            bestMove = list.candidates[i]; // 更新最佳着法
+        // 步骤 5e: 采纳本轮结果
+        // 中止的轮次中, 排在首位的是上一轮的最佳着法, 只要它已搜完,
+        // 本轮已搜完着法中超过 alpha 的最优者就不会比上一轮的结论差, 仍然可以采纳
+        if (iterBestIndex >= 0) {
+            bestMove = list->candidates[iterBestIndex];
+            // 将最佳着法移到列表首位, 下一轮优先搜索它
+            for (int i = iterBestIndex; i > 0; i--) {
+                list->candidates[i] = list->candidates[i - 1];
+            }
+            list->candidates[0] = bestMove;
+        }
+        previousScore = score;
+
+        // 步骤 5f: 预算耗尽或已分出胜负 (更深的搜索不会改变结论), 停止加深
+        if (searchStopped() || score >= SCORE_MAX - 1LL || score <= SCORE_MIN + 1LL) {
+            break;
         }
     }
 
-    // 步骤 6: 返回找到的最佳着法
+#ifndef GOMOKU_WASM
+    // 步骤 6: 主线程结束后中止 Lazy SMP 的辅助线程 / 结束 YBWC 辅助线程的等待
+    if (lazyHelpers) {
+        stopSearchHelpers();
+    }
+    if (splitHelpers) {
+        stopSplitHelpers();
+    }
+#endif
+
+    // 步骤 7: 返回找到的最佳着法
     return bestMove;
 }
 
 #ifdef GOMOKU_WASM
-WASM_EXPORT void gomoku_init(const int humanPlayerId, const unsigned int seed, const int boardSize) {
+WASM_EXPORT void gomoku_init(const int humanPlayerId, const unsigned int seed, const int boardSize, const int hashMB) {
     if (boardSize > 0 && boardSize <= MAX_BOARD_SIZE) {
         BOARD_SIZE = boardSize;
     }
+    // 置换表容量: 0 (包括省略此参数的旧版前端) 表示默认容量; 容量变化时才重新分配
+    const int tableMB = hashMB > 0 ? hashMB : TT_DEFAULT_MB;
+    if (tableMB != gTtMegabytes) {
+        ttResize(tableMB);
+    }
     loadPatternScores();
     ttInit((ULL) seed);
     boardInit(&gCurrentBoard);
@@ -893,10 +4362,28 @@ WASM_EXPORT void gomoku_init(const int humanPlayerId, const unsigned int seed, c
     gAiPlayerId = humanPlayerId == PIECE_B ? PIECE_W : PIECE_B;
 }
 
+WASM_EXPORT void gomoku_set_search_limits(const int maxDepth, const int timeLimitMs, const unsigned int nodeLimit) {
+    gSearchLimits.maxDepth = maxDepth > 0 ? maxDepth : SEARCH_DEPTH;
+    gSearchLimits.timeLimitMs = timeLimitMs > 0 ? timeLimitMs : 0;
+    gSearchLimits.nodeLimit = nodeLimit;
+}
+
+WASM_EXPORT void gomoku_set_lmr(const int maxCandidates, const int fullDepthMoves, const int minDepth, const int reduction) {
+    gLmrConfig.maxCandidates = maxCandidates;
+    gLmrConfig.fullDepthMoves = fullDepthMoves;
+    gLmrConfig.minDepth = minDepth;
+    gLmrConfig.reduction = reduction;
+}
+
+WASM_EXPORT void gomoku_set_symmetry(const int enabled) {
+    gSymmetryHash = enabled != 0;
+    boardRehashSymmetry(&gCurrentBoard);
+}
+
 WASM_EXPORT void gomoku_get_board_copy(int *outBoard) {
     for (int row = 0; row < BOARD_SIZE; row++) {
         for (int col = 0; col < BOARD_SIZE; col++) {
-            outBoard[row * BOARD_SIZE + col] = gCurrentBoard.layout[row][col];
+            outBoard[row * BOARD_SIZE + col] = gCurrentBoard.cells[CELL_INDEX(row, col)];
         }
     }
 }
@@ -924,6 +4411,19 @@ WASM_EXPORT int gomoku_determine_next_play_packed(void) {
     return (nextMove.row << 8) | (nextMove.col & 0xFF);
 }
 
+WASM_EXPORT int gomoku_solve_vct(const int player, const unsigned int nodeLimit, int *outCoords, const int maxPairs) {
+    if (player != PIECE_B && player != PIECE_W) {
+        return 0;
+    }
+    Coord line[VCT_MAX_LINE + 1];
+    const int length = vctSolve(&gCurrentBoard, player, nodeLimit > 0 ? nodeLimit : VCT_NODE_LIMIT, 0, line);
+    for (int k = 0; k < length && k < maxPairs && outCoords != 0; k++) {
+        outCoords[k * 2] = line[k].row;
+        outCoords[k * 2 + 1] = line[k].col;
+    }
+    return length;
+}
+
 WASM_EXPORT int gomoku_check_win(const int row, const int col, const int player) {
     if (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE) {
         return 0;
@@ -933,66 +4433,367 @@ WASM_EXPORT int gomoku_check_win(const int row, const int col, const int player)
 }
 
 WASM_EXPORT int gomoku_get_winning_line(const int row, const int col, const int player, int *outCoords, const int maxPairs) {
-    if (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE || outCoords == 0 || maxPairs <= 0) {
+    // player 不能是 CELL_WALL (否则会沿哨兵格走出棋盘)
+    if (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE || player < EMPTY_SLOT || player > PIECE_W || outCoords == 0 || maxPairs <= 0) {
         return 0;
     }
 
+    const int center = CELL_INDEX(row, col);
     for (int i = 0; i < 4; i++) {
-        int lineCount = 0;
-        const int dr = gDirectionRow[i];
-        const int dc = gDirectionCol[i];
-        int currR = row;
-        int currC = col;
-
-        while (currR >= 0 && currR < BOARD_SIZE && currC >= 0 && currC < BOARD_SIZE && gCurrentBoard.layout[currR][currC] == player) {
-            lineCount++;
-            currR += dr;
-            currC += dc;
+        // 沿两个方向数连续的 player 棋子 (走到对方棋子, 空点或哨兵格为止)
+        const int step = gDirectionStride[i];
+        int ahead = 0; // 含 (row, col) 本身
+        int behind = 0;
+        while (gCurrentBoard.cells[center + ahead * step] == player) {
+            ahead++;
         }
-
-        currR = row - dr;
-        currC = col - dc;
-        while (currR >= 0 && currR < BOARD_SIZE && currC >= 0 && currC < BOARD_SIZE && gCurrentBoard.layout[currR][currC] == player) {
-            lineCount++;
-            currR -= dr;
-            currC -= dc;
+        while (gCurrentBoard.cells[center - (behind + 1) * step] == player) {
+            behind++;
         }
 
-        if (lineCount >= 5) {
+        if (ahead + behind >= 5) {
+            // 容量不足时优先保留正向 (含落子点) 的棋子, 按从反向末端到正向末端的顺序输出
+            const int forward = ahead < maxPairs ? ahead : maxPairs;
+            const int backward = behind < maxPairs - forward ? behind : maxPairs - forward;
             int index = 0;
-            currR = row;
-            currC = col;
-            while (currR >= 0 && currR < BOARD_SIZE && currC >= 0 && currC < BOARD_SIZE && gCurrentBoard.layout[currR][currC] == player && index < maxPairs) {
-                outCoords[index * 2] = currR;
-                outCoords[index * 2 + 1] = currC;
+            for (int k = -backward; k < forward; k++) {
+                outCoords[index * 2] = row + k * gDirectionRow[i];
+                outCoords[index * 2 + 1] = col + k * gDirectionCol[i];
                 index++;
-                currR += dr;
-                currC += dc;
             }
+            return index;
+        }
+    }
+
+    return 0;
+}
+#endif
+
+#ifndef GOMOKU_WASM
+// --- 基准测试 --- //
+
+/**
+ * @brief 基准局面 (原生中心四子开局之后, 黑方先手交替落子)
+ */
+typedef struct {
+    int aiPlayerId; // 轮到哪一方 (AI 执此棋)
+    const char *moves; // 开局之后的着法序列 "row col row col ..."
+} BenchPosition;
+
+static const BenchPosition gBenchPositions[] = {
+    {PIECE_B, ""},
+    {PIECE_W, "4 4"},
+    {PIECE_B, "4 4 4 7 5 4 6 4 4 3 3 2"},
+    {PIECE_W, "4 4 4 7 5 4 6 4 4 3 3 2 4 5 4 6 3 7"},
+    {PIECE_B, "4 4 4 7 5 4 6 4 4 3 3 2 4 5 4 6 3 7 3 4 3 6 2 7 3 3 6 3"},
+    {PIECE_W, "4 4 4 7 5 4 6 4 4 3 3 2 4 5 4 6 3 7 3 4 3 6 2 7 3 3 6 3 2 3 7 3 8 2 5 3 3 8"},
+    {PIECE_B, "4 4 4 7 5 4 6 4 4 3 3 2 4 5 4 6 3 7 3 4 3 6 2 7 3 3 6 3 2 3 7 3 8 2 5 3 3 8 8 3 9 3 3 5 4 2 4 1 2 4 1 5 2 2 2 5 1 3 0 3"},
+    {PIECE_W, "4 4 4 7 5 4 6 4 4 3 3 2 4 5 4 6 3 7 3 4 3 6 2 7 3 3 6 3 2 3 7 3 8 2 5 3 3 8 8 3 9 3 3 5 4 2 4 1 2 4 1 5 2 2 2 5 1 3 0 3 7 1 10 4 5 2 6 2 5 1"},
+};
+
+/**
+ * @brief 在固定局面集上以固定深度搜索, 输出每个局面的节点数与耗时
+ * (用于比较搜索改动前后的节点数, 不影响当前对局状态; 使用与当前容量相同的临时置换表, 对局的置换表与映射的文件不受影响)
+ * @param depth 固定搜索深度 (迭代加深的最大深度)
+ */
+void runBenchmark(const int depth) {
+    // 步骤 1: 保存对局状态 (置换表换成临时表), 基准测试只使用固定深度, 不受时间和节点预算限制
+    TT_SavedTable savedTable;
+    if (!ttUseScratchTable(&savedTable, gTtMegabytes)) {
+        printf("BENCH ERROR\n");
+        fflush(stdout);
+        return;
+    }
+    const ChessBoard savedBoard = gCurrentBoard;
+    const SearchLimits savedLimits = gSearchLimits;
+    const int savedAiPlayerId = gAiPlayerId;
+    gSearchLimits.maxDepth = depth;
+    gSearchLimits.timeLimitMs = 0;
+    gSearchLimits.nodeLimit = 0;
+
+    ULL totalNodes = 0;
+    LL totalMs = 0;
+    const int positionCount = (int) (sizeof(gBenchPositions) / sizeof(gBenchPositions[0]));
+
+    // 步骤 2: 逐个局面搜索
+    for (int i = 0; i < positionCount; i++) {
+        boardInit(&gCurrentBoard);
+        const char *cursor = gBenchPositions[i].moves;
+        int row, col, consumed, player = PIECE_B;
+        while (sscanf(cursor, "%d %d%n", &row, &col, &consumed) == 2) {
+            boardUpdate(&gCurrentBoard, row, col, player);
+            player = 3 - player;
+            cursor += consumed;
+        }
+        gAiPlayerId = gBenchPositions[i].aiPlayerId;
+        gOppPlayerId = 3 - gAiPlayerId;
+
+        clearTranspositionTable(); // 每个局面都从空置换表开始, 结果与局面顺序无关
+        const Coord move = determineNextPlay(&gCurrentBoard);
+        const LL elapsedMs = getTimeMs() - gSearchState.startMs;
+        const ULL nodes = searchNodeCount();
+        totalNodes += nodes;
+        totalMs += elapsedMs;
+        printf("BENCH %d move %d %d nodes %llu time %lld\n", i, move.row, move.col, nodes, elapsedMs);
+    }
+    printf("BENCH total nodes %llu time %lld nps %llu\n", totalNodes, totalMs, totalMs > 0 ? totalNodes * 1000ULL / (ULL) totalMs : totalNodes);
+    fflush(stdout);
+
+    // 步骤 3: 恢复对局状态
+    ttRestoreTable(&savedTable);
+    gCurrentBoard = savedBoard;
+    gSearchLimits = savedLimits;
+    gAiPlayerId = savedAiPlayerId;
+    gOppPlayerId = 3 - savedAiPlayerId;
+}
+
+// --- 置换表压力测试 --- //
+
+#define TT_STRESS_KEYS 4096           // 压力测试的键池大小
+#define TT_STRESS_BUCKETS 16          // 键池只映射到置换表的少数几个桶 (每桶被大量线程同时读写)
+
+/**
+ * @brief 压力测试线程的统计 (按缓存行对齐, 各线程的计数器互不干扰)
+ */
+typedef struct __attribute__((aligned(64))) {
+    ULL seed; // 线程私有的 xorshift 状态
+    ULL stores;
+    ULL probes;
+    ULL hits; // 键匹配且返回了分数的查询
+    ULL torn; // 查询时在桶中看到的交错写入条目 (还原出的键不属于键池, 校验会拒绝它们)
+    ULL corrupt; // 命中但分数或着法与该键写入的内容不符 (应当始终为 0)
+} TtStressWorker;
+
+static ULL gTtStressKeys[TT_STRESS_KEYS];
+static TtStressWorker gTtStressWorkers[MAX_THREADS];
+static LL gTtStressDeadlineMs;
+
+/**
+ * @brief 某个键在压力测试中写入的分数 (由键决定, 查询时据此检验)
+ */
+LL ttStressScore(const ULL key) {
+    return (LL) (key >> 40) - (1LL << 23);
+}
+
+int ttStressMove(const ULL key) {
+    return (int) ((key >> 32) % (MAX_BOARD_SIZE * MAX_BOARD_SIZE));
+}
 
-            currR = row - dr;
-            currC = col - dc;
-            while (currR >= 0 && currR < BOARD_SIZE && currC >= 0 && currC < BOARD_SIZE && gCurrentBoard.layout[currR][currC] == player && index < maxPairs) {
-                for (int swap = index; swap > 0; swap--) {
-                    outCoords[swap * 2] = outCoords[(swap - 1) * 2];
-                    outCoords[swap * 2 + 1] = outCoords[(swap - 1) * 2 + 1];
+/**
+ * @brief 压力测试线程: 随机从键池中取键, 一半写入 (分数与着法由键决定), 一半查询并检验
+ */
+void ttStressLoop(TtStressWorker *worker) {
+    ULL state = worker->seed;
+    for (ULL n = 1;; n++) {
+        if ((n & 1023) == 0 && getTimeMs() >= gTtStressDeadlineMs) {
+            break;
+        }
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        const ULL random = state * 0x2545F4914F6CDD1DULL;
+        const ULL key = gTtStressKeys[random % TT_STRESS_KEYS];
+
+        if (random >> 63) {
+            ttStore(key, (int) (key >> 48 & 31), ttStressScore(key), TT_TYPE_EXACT, ttStressMove(key));
+            worker->stores++;
+        } else {
+            int move;
+            const LL score = ttSearch(key, 0, SCORE_MIN, SCORE_MAX, &move);
+            worker->probes++;
+            // 键池中的键低 32 位都小于 TT_STRESS_BUCKETS, 还原出其他值的条目一定是两次写入交错的结果 (全 0 的空条目除外)
+            const ULL sideKey = gTtSideKeys[gAiPlayerId];
+            const TT_Bucket *bucket = &gTranspositionTable[(key ^ sideKey) & (gTtBucketCount - 1)];
+            for (int k = 0; k < TT_BUCKET_SIZE; k++) {
+                const ULL data = __atomic_load_n(&bucket->entries[k].data, __ATOMIC_RELAXED);
+                const ULL restored = __atomic_load_n(&bucket->entries[k].keyXorData, __ATOMIC_RELAXED) ^ data;
+                if (restored != 0 && ((restored ^ sideKey) & 0xFFFFFFFFULL) >= TT_STRESS_BUCKETS) {
+                    worker->torn++;
+                }
+            }
+            if (score > SCORE_MIN - 1LL) {
+                worker->hits++;
+                if (score != ttStressScore(key) || move != ttStressMove(key)) {
+                    worker->corrupt++;
                 }
-                outCoords[0] = currR;
-                outCoords[1] = currC;
-                index++;
-                currR -= dr;
-                currC -= dc;
             }
+        }
+    }
+}
 
-            return index;
+#ifdef _WIN32
+static DWORD WINAPI ttStressThreadMain(LPVOID arg) {
+    ttStressLoop((TtStressWorker *) arg);
+    return 0;
+}
+#else
+static void *ttStressThreadMain(void *arg) {
+    ttStressLoop((TtStressWorker *) arg);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief 置换表无锁协议的压力测试: 多个线程同时对少数几个桶反复写入与查询, 统计校验通过却内容错误的命中
+ * (在临时的 1MB 置换表上进行; 对局的置换表与映射的文件不受影响).
+ * 修改置换表的读写协议后以此验证: 没有内容错误的命中 (且确有命中) 时输出 PASS, 否则输出 FAIL
+ * @param threadCount 线程数
+ * @param seconds 持续时间 (秒)
+ */
+void runTtStress(const int threadCount, const int seconds) {
+    // 步骤 1: 生成键池: 低 32 位只取 TT_STRESS_BUCKETS 个值 (落在同一批桶里), 高 32 位随机
+    const int threads = threadCount < 1 ? 1 : threadCount > MAX_THREADS ? MAX_THREADS : threadCount;
+    for (int i = 0; i < TT_STRESS_KEYS; i++) {
+        gTtStressKeys[i] = (genU64Rand() & 0xFFFFFFFF00000000ULL) | (ULL) (i % TT_STRESS_BUCKETS);
+    }
+    TT_SavedTable saved;
+    if (!ttUseScratchTable(&saved, 1)) {
+        printf("TTSTRESS ERROR\n");
+        fflush(stdout);
+        return;
+    }
+
+    // 步骤 2: 启动线程 (创建失败时以已创建的线程继续), 等待结束
+    ThreadHandle handles[MAX_THREADS];
+    int started = 0;
+    gTtStressDeadlineMs = getTimeMs() + (seconds > 0 ? seconds : 1) * 1000LL;
+    for (int t = 0; t < threads; t++) {
+        TtStressWorker *worker = &gTtStressWorkers[t];
+        worker->seed = genU64Rand() | 1;
+        worker->stores = worker->probes = worker->hits = worker->torn = worker->corrupt = 0;
+        if (!threadStart(&handles[started], ttStressThreadMain, worker)) {
+            break;
+        }
+        started++;
+    }
+    for (int t = 0; t < started; t++) {
+        threadJoin(handles[t]);
+    }
+
+    // 步骤 3: 汇总并输出, 换回对局的置换表
+    ULL stores = 0, probes = 0, hits = 0, torn = 0, corrupt = 0;
+    for (int t = 0; t < started; t++) {
+        stores += gTtStressWorkers[t].stores;
+        probes += gTtStressWorkers[t].probes;
+        hits += gTtStressWorkers[t].hits;
+        torn += gTtStressWorkers[t].torn;
+        corrupt += gTtStressWorkers[t].corrupt;
+    }
+    printf("TTSTRESS threads %d stores %llu probes %llu hits %llu torn %llu corrupt %llu %s\n", started, stores, probes, hits, torn, corrupt, corrupt == 0 && hits > 0 ? "PASS" : "FAIL");
+    fflush(stdout);
+    ttRestoreTable(&saved);
+}
+
+// --- 后台思考 (Ponder) --- //
+
+static int gPonderEnabled; // PONDER 命令的开关
+static int gPonderState = PONDER_IDLE;
+static Coord gPonderMove; // 预测的对手应着
+static ChessBoard gPonderBoard; // 预测着法之后的局面 (后台搜索的根节点)
+static Coord gPonderResult; // 后台搜索的结果
+static ThreadHandle gPonderThread;
+
+/**
+ * @brief 预测对手的应着: 优先取置换表记录的最佳着法 (即刚结束的搜索的主变例), 没有时取对手候选着法的第一个
+ * @param board 我方落子之后的局面
+ * @param move (出参) 预测着法
+ * @return 1 (有可预测的着法) 或 0 (无处可下)
+ */
+int predictReply(const ChessBoard *board, Coord *move) {
+    // 步骤 1: 置换表着法 (深度参数只影响分数是否命中, 着法总会返回)
+    int hashMove;
+    ttSearchBoard(board, 0, SCORE_MIN, SCORE_MAX, &hashMove);
+    if (hashMove != MOVE_NONE) {
+        move->row = hashMove / MAX_BOARD_SIZE;
+        move->col = hashMove % MAX_BOARD_SIZE;
+        if (move->row < BOARD_SIZE && move->col < BOARD_SIZE && board->cells[CELL_INDEX(move->row, move->col)] == EMPTY_SLOT) {
+            return 1;
         }
     }
 
+    // 步骤 2: 退回到着法排序的第一个候选
+    CandidateList list;
+    generateCandidates(&gWorkers[0], board, &list, 0, gOppPlayerId);
+    if (list.count == 0) {
+        return 0;
+    }
+    *move = list.candidates[0];
+    return 1;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI ponderThreadMain(LPVOID arg) {
+    (void) arg;
+    gPonderResult = determineNextPlay(&gPonderBoard);
     return 0;
 }
+#else
+static void *ponderThreadMain(void *arg) {
+    (void) arg;
+    gPonderResult = determineNextPlay(&gPonderBoard);
+    return NULL;
+}
 #endif
 
-#ifndef GOMOKU_WASM
+/**
+ * @brief 我方落子后开始后台思考: 假设对手下预测的应着, 在后台线程中提前搜索我方的下一步
+ * @param lastMove 我方刚下的着法 (已经取胜时不思考)
+ */
+void ponderStart(const Coord lastMove) {
+    // 步骤 1: 已分出胜负或无处可下时不思考
+    if (getPlayerThreat(&gCurrentBoard, lastMove, gAiPlayerId) >= 1111111111LL || !predictReply(&gCurrentBoard, &gPonderMove)) {
+        return;
+    }
+
+    // 步骤 2: 在主线程上启动计时并标记为后台思考 (此后收到的 searchStop 不会被后台线程的 searchBegin 覆盖)
+    gPonderBoard = gCurrentBoard;
+    boardUpdate(&gPonderBoard, gPonderMove.row, gPonderMove.col, gOppPlayerId);
+    searchBegin();
+    gSearchState.pondering = 1;
+    gPonderSearch = 1;
+
+    // 步骤 3: 启动后台线程 (创建失败时放弃思考)
+    if (!threadStart(&gPonderThread, ponderThreadMain, NULL)) {
+        gSearchState.pondering = 0;
+        gPonderSearch = 0;
+        return;
+    }
+    gPonderState = PONDER_RUNNING;
+}
+
+/**
+ * @brief 对手下了预测的着法: 后台搜索转为正式搜索, 预算从此刻起按正常规则计算 (已完成的迭代全部保留)
+ */
+void ponderHit() {
+    gSearchState.startMs = getTimeMs();
+    gSearchState.deadlineMs = gSearchLimits.timeLimitMs > 0 ? gSearchState.startMs + gSearchLimits.timeLimitMs : 0;
+    gSearchState.nodeBase = sumWorkerNodes();
+    __atomic_store_n(&gSearchState.pondering, 0, __ATOMIC_RELEASE);
+    gPonderState = PONDER_HIT;
+}
+
+/**
+ * @brief 等待后台搜索结束并取结果 (只在命中后调用)
+ * @return 最佳着法
+ */
+Coord ponderFinish() {
+    threadJoin(gPonderThread);
+    gPonderSearch = 0;
+    gPonderState = PONDER_IDLE;
+    return gPonderResult;
+}
+
+/**
+ * @brief 放弃后台思考 (预测失败或收到其他命令): 中止搜索并等待后台线程退出, 置换表中的结果保留
+ */
+void ponderCancel() {
+    searchStop();
+    threadJoin(gPonderThread);
+    gSearchState.pondering = 0;
+    gPonderSearch = 0;
+    gPonderState = PONDER_IDLE;
+}
+
 // --- 主函数 --- //
 
 /**
@@ -1002,7 +4803,8 @@ WASM_EXPORT int gomoku_get_winning_line(const int row, const int col, const int
 int main() {
     // --- 步骤 1: 全局初始化 ---
     loadPatternScores(); // 计算对手棋型分
-    ttInit((ULL) time(NULL)); // 初始化 Zobrist 键和置换表
+    ttInit(ZOBRIST_SEED); // 初始化 Zobrist 键和置换表 (固定种子: 键跨进程不变, 置换表文件可以沿用)
+    scanSelectKernel(SCAN_KERNEL_AUTO); // 按 CPUID 选择全盘扫描内核
 
     // --- 步骤 2: 主循环 (读取命令并响应) ---
     char line_buffer[256]; // 定义一个足够大的行缓冲区
@@ -1016,12 +4818,21 @@ int main() {
             continue; // 如果是空行或无效输入，则跳过
         }
 
+        // 步骤 2b: 后台思考期间收到命令: 只有 "PLACE <预测着法>" 与随后的 "TURN" 沿用后台搜索, 其余命令先放弃后台思考
+        if ((gPonderState == PONDER_RUNNING && strcmp(input, "PLACE") != 0) || (gPonderState == PONDER_HIT && strcmp(input, "TURN") != 0)) {
+            ponderCancel();
+        }
+
         // 步骤 2c: 处理 "START" 命令
         if (strcmp(input, "START") == 0) {
             // 从 line_buffer 中解析 "START" 之后的数字
             if (sscanf(line_buffer, "START %d", &gAiPlayerId) == 1) {
                 gOppPlayerId = gAiPlayerId == 1 ? 2 : 1; // 确定对手颜色
                 boardInit(&gCurrentBoard); // 初始化棋盘 (空棋盘)
+                // 新对局从空置换表开始 (映射的置换表文件除外: 它的用途就是跨对局与跨进程保留分析结果)
+                if (gTtMapping == NULL) {
+                    clearTranspositionTable();
+                }
                 // 做出响应
                 printf("OK\n");
                 fflush(stdout);
@@ -1033,24 +4844,202 @@ int main() {
             if (sscanf(line_buffer, "PLACE %d %d", &movePos.row, &movePos.col) == 2) {
                 // 更新棋盘
                 boardUpdate(&gCurrentBoard, movePos.row, movePos.col, gOppPlayerId);
+                // 正在后台思考时: 猜中则转为正式搜索, 猜错则放弃
+                if (gPonderState == PONDER_RUNNING) {
+                    if (movePos.row == gPonderMove.row && movePos.col == gPonderMove.col) {
+                        ponderHit();
+                    } else {
+                        ponderCancel();
+                    }
+                }
             }
 
             // 步骤 2e: 处理 "TURN" 命令 (轮到 AI)
         } else if (strcmp(input, "TURN") == 0) {
-            // 决定下一步
-            const Coord nextMove = determineNextPlay(&gCurrentBoard);
+            // 决定下一步 (后台思考命中时直接沿用后台搜索的结果)
+            const Coord nextMove = gPonderState == PONDER_HIT ? ponderFinish() : determineNextPlay(&gCurrentBoard);
             // 输出走法
             printf("%d %d\n", nextMove.row, nextMove.col);
             fflush(stdout);
             // 更新棋盘
             boardUpdate(&gCurrentBoard, nextMove.row, nextMove.col, gAiPlayerId);
+            // 开启后台思考时, 在等待对手落子期间搜索预测的对手应着
+            if (gPonderEnabled) {
+                ponderStart(nextMove);
+            }
+
+            // 步骤 2f: 处理搜索预算命令 ("TIME <毫秒>", "NODES <节点数>", "DEPTH <层数>"; 0 表示不限)
+        } else if (strcmp(input, "TIME") == 0) {
+            long long timeLimitMs;
+            if (sscanf(line_buffer, "TIME %lld", &timeLimitMs) == 1) {
+                gSearchLimits.timeLimitMs = timeLimitMs > 0 ? timeLimitMs : 0;
+            }
+        } else if (strcmp(input, "NODES") == 0) {
+            unsigned long long nodeLimit;
+            if (sscanf(line_buffer, "NODES %llu", &nodeLimit) == 1) {
+                gSearchLimits.nodeLimit = nodeLimit;
+            }
+        } else if (strcmp(input, "DEPTH") == 0) {
+            int maxDepth;
+            if (sscanf(line_buffer, "DEPTH %d", &maxDepth) == 1) {
+                gSearchLimits.maxDepth = maxDepth > 0 ? maxDepth : SEARCH_DEPTH;
+            }
+
+            // 步骤 2f-1: 处理 "THREADS <n>" (搜索线程数, 1 表示单线程) 与 "SMP <lazy|root|ybwc>" (并行方式) 命令
+        } else if (strcmp(input, "THREADS") == 0) {
+            int threadCount;
+            if (sscanf(line_buffer, "THREADS %d", &threadCount) == 1) {
+                gThreadCount = threadCount < 1 ? 1 : threadCount > MAX_THREADS ? MAX_THREADS : threadCount;
+            }
+        } else if (strcmp(input, "SMP") == 0) {
+            // "SMP lazy", "SMP root" 或 "SMP ybwc": 多线程的并行方式
+            char mode[20];
+            if (sscanf(line_buffer, "SMP %19s", mode) == 1) {
+                if (strcmp(mode, "lazy") == 0) {
+                    gParallelMode = PARALLEL_LAZY;
+                } else if (strcmp(mode, "root") == 0) {
+                    gParallelMode = PARALLEL_ROOT;
+                } else if (strcmp(mode, "ybwc") == 0) {
+                    gParallelMode = PARALLEL_YBWC;
+                }
+            }
+
+            // 步骤 2f-2: 处理 "PONDER <0|1>" 命令 (关闭/开启后台思考)
+        } else if (strcmp(input, "PONDER") == 0) {
+            int enabled;
+            if (sscanf(line_buffer, "PONDER %d", &enabled) == 1) {
+                gPonderEnabled = enabled != 0;
+            }
+
+            // 步骤 2f-3: 处理 "HASH <MB>" 命令 (重新分配并清空置换表)
+        } else if (strcmp(input, "HASH") == 0) {
+            int megabytes;
+            if (sscanf(line_buffer, "HASH %d", &megabytes) == 1) {
+                ttResize(megabytes);
+            }
+
+            // 步骤 2f-4: 处理 "HASHFILE <path>" (把文件映射为置换表) 与 "HASHSAVE" (写回文件) 命令
+        } else if (strcmp(input, "HASHFILE") == 0) {
+            char path[200];
+            int created;
+            // 输出 "HASHFILE LOADED <MB>", "HASHFILE CREATED <MB>" 或 "HASHFILE ERROR"
+            if (sscanf(line_buffer, "HASHFILE %199[^\r\n]", path) == 1 && ttMapFile(path, &created)) {
+                printf("HASHFILE %s %d\n", created ? "CREATED" : "LOADED", gTtMegabytes);
+            } else {
+                printf("HASHFILE ERROR\n");
+            }
+            fflush(stdout);
+        } else if (strcmp(input, "HASHSAVE") == 0) {
+            printf("HASHSAVE %s\n", ttSaveFile() ? "OK" : "ERROR");
+            fflush(stdout);
+
+            // 步骤 2f-5: 处理 "SYMMETRY <0|1>" 命令 (置换表是否按规范局面共用对称局面的条目)
+        } else if (strcmp(input, "SYMMETRY") == 0) {
+            int enabled;
+            if (sscanf(line_buffer, "SYMMETRY %d", &enabled) == 1) {
+                gSymmetryHash = enabled != 0;
+                boardRehashSymmetry(&gCurrentBoard);
+            }
+
+            // 步骤 2f-6: 处理 "SIMD [auto|scalar|sse2]" 命令 (切换全盘扫描内核, 本机不支持时保持原内核), 输出 "SIMD <当前内核>"
+        } else if (strcmp(input, "SIMD") == 0) {
+            static const char *const kernelNames[] = {"scalar", "sse2"};
+            char name[16];
+            if (sscanf(line_buffer, "SIMD %15s", name) == 1) {
+                int kernel = strcmp(name, "auto") == 0 ? SCAN_KERNEL_AUTO : -2;
+                for (int k = SCAN_KERNEL_SCALAR; k <= SCAN_KERNEL_SSE2; k++) {
+                    if (strcmp(name, kernelNames[k]) == 0) {
+                        kernel = k;
+                    }
+                }
+                scanSelectKernel(kernel);
+            }
+            printf("SIMD %s\n", kernelNames[gScanKernel]);
+            fflush(stdout);
+
+            // 步骤 2g: 处理 "LMR <宽度> <全深度着法数> <最小深度> <缩减层数>" 命令 (宽度 0 表示不限, 缩减 0 表示关闭 LMR)
+        } else if (strcmp(input, "LMR") == 0) {
+            LmrConfig config;
+            if (sscanf(line_buffer, "LMR %d %d %d %d", &config.maxCandidates, &config.fullDepthMoves, &config.minDepth, &config.reduction) == 4) {
+                gLmrConfig = config;
+            }
 
-            // 步骤 2f: 处理 "END" 命令
+            // 步骤 2h: 处理 "BENCH [depth]" 命令 (固定局面集基准测试)
+        } else if (strcmp(input, "BENCH") == 0) {
+            int depth;
+            if (sscanf(line_buffer, "BENCH %d", &depth) != 1 || depth <= 0) {
+                depth = SEARCH_DEPTH;
+            }
+            runBenchmark(depth);
+
+            // 步骤 2h-1: 处理 "TTSTRESS <threads> <seconds>" 命令 (置换表无锁协议压力测试)
+        } else if (strcmp(input, "TTSTRESS") == 0) {
+            int threadCount = 32;
+            int seconds = 5;
+            sscanf(line_buffer, "TTSTRESS %d %d", &threadCount, &seconds);
+            runTtStress(threadCount, seconds);
+
+            // 步骤 2i: 处理 "VCT [player] [nodeLimit]" 命令 (分析当前局面: player 先走能否连续冲四/活三取胜)
+        } else if (strcmp(input, "VCT") == 0) {
+            int player = gAiPlayerId;
+            unsigned long long nodeLimit = VCT_NODE_LIMIT;
+            const int parsed = sscanf(line_buffer, "VCT %d %llu", &player, &nodeLimit);
+            if (parsed < 1 || (player != 1 && player != 2)) {
+                player = gAiPlayerId;
+            }
+            Coord vctLine[VCT_MAX_LINE + 1];
+            const int length = vctSolve(&gCurrentBoard, player, nodeLimit, 0, vctLine);
+            // 输出 "WIN <长度> r c r c ..." 或 "NONE"
+            if (length > 0) {
+                printf("WIN %d", length);
+                for (int k = 0; k < length; k++) {
+                    printf(" %d %d", vctLine[k].row, vctLine[k].col);
+                }
+                printf("\n");
+            } else {
+                printf("NONE\n");
+            }
+            fflush(stdout);
+
+            // 步骤 2j: 处理 "SOLVE [player] [nodeLimit] [MB]" 命令 (df-pn 证明当前局面 player 先走是否必胜)
+        } else if (strcmp(input, "SOLVE") == 0) {
+            int player = gAiPlayerId;
+            unsigned long long nodeLimit = DFPN_NODE_LIMIT;
+            int megabytes = 0;
+            const int parsed = sscanf(line_buffer, "SOLVE %d %llu %d", &player, &nodeLimit, &megabytes);
+            if (parsed < 1 || (player != 1 && player != 2)) {
+                player = gAiPlayerId;
+            }
+            if (megabytes > 0 && megabytes != gDfpnTableMB) {
+                dfpnAllocate(megabytes);
+            }
+            Coord solveLine[DFPN_MAX_LINE];
+            int length;
+            const int result = dfpnSolve(&gCurrentBoard, player, nodeLimit, solveLine, &length);
+            // 输出 "PROVEN <节点数> <长度> r c r c ...", "DISPROVEN <节点数>" 或 "UNKNOWN <节点数>"
+            if (result == DFPN_PROVEN) {
+                printf("PROVEN %llu %d", gDfpnNodes, length);
+                for (int k = 0; k < length; k++) {
+                    printf(" %d %d", solveLine[k].row, solveLine[k].col);
+                }
+                printf("\n");
+            } else {
+                printf("%s %llu\n", result == DFPN_DISPROVEN ? "DISPROVEN" : "UNKNOWN", gDfpnNodes);
+            }
+            fflush(stdout);
+
+            // 步骤 2k: 处理 "END" 命令
         } else if (strcmp(input, "END") == 0) {
             break; // 退出主循环
         }
     }
 
+    // 步骤 3: 输入结束时放弃仍在进行的后台思考, 并把映射的置换表写回文件
+    if (gPonderState != PONDER_IDLE) {
+        ponderCancel();
+    }
+    ttReleaseTable();
+
     return 0;
 }
 #endif